@@ -99,7 +99,7 @@ int main(int argc, char* argv[]) {
     // "redis connect failed");
 
     test_coro_1(ioc, host, port);
-    coro_redis_test(ioc, host, port);
+    coro_redis_test(ioc, host, port).detach();
     // libevent event reactor
     LOG_INFO("event is run and wait exit...");
     ioc.loop();
@@ -12,5 +12,5 @@ task<bool> test_coro_impl(const coro_redis::io_context& ioc, std::string_view ho
 }
 
 void test_coro_1(const coro_redis::io_context& ioc, std::string_view host, uint16_t port) {
-    test_coro_impl(ioc, host, port);
+    test_coro_impl(ioc, host, port).detach();
 }
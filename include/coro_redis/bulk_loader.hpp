@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2020 Gu.Qiwei(gqwmail@qq.com)
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+//
+#pragma once
+
+#include <coro_redis/impl/bulk_loader.ipp>
+
+namespace coro_redis {
+
+///
+/// @brief Streams a large number of write commands without waiting a round
+///   trip for each one.
+///
+/// Commands are written as soon as they are added, until `max_inflight`
+/// commands or `max_bytes` encoded bytes wait for their reply, then `add`
+/// suspends the producer until replies free the window. Commands are spread
+/// over the given connections, each one goes to the connection with the
+/// fewest replies outstanding.
+///
+/// One coroutine adds the commands. All connections must be driven by the
+/// event loop this coroutine runs on, e.g. connections fetched from the pool
+/// on the same `io_context`. Destroying the loader before `flush` is done,
+/// e.g. when the producer throws, is safe: the replies still in flight are
+/// dropped and the connections are kept until they arrive.
+///
+/// Example:
+/// @code{.cpp}
+///   bulk_loader loader({conn1, conn2}, {.max_inflight = 4096});
+///   loader.set_error_handler([](uint64_t tag, std::string_view err) {
+///       LOG_ERROR("row {} failed, {}", tag, err);
+///   });
+///   for (uint64_t i = 0; i < rows.size(); ++i) {
+///       co_await loader.add(i, "hset", rows[i].key, "field", rows[i].val);
+///   }
+///   bulk_stats stats = co_await loader.flush();
+/// @endcode
+///
+class bulk_loader {
+  public:
+    ///
+    /// @brief construction
+    ///
+    /// @param conns Connections the commands are spread over
+    /// @param opt In flight window and progress interval
+    ///
+    explicit bulk_loader(std::vector<std::shared_ptr<coro_connection>> conns,
+                         bulk_options opt = {})
+        : impl_(new impl::bulk_loader_impl(std::move(conns), opt)) {}
+
+    ~bulk_loader() { impl_->release(); }
+
+    bulk_loader(const bulk_loader&) = delete;
+    bulk_loader& operator=(const bulk_loader&) = delete;
+
+    ///
+    /// @brief Write one command, suspends while the window is full.
+    ///
+    /// @param tag Passed to the error handler if the command fails, e.g. the
+    ///   row number
+    /// @param name Command name
+    /// @param args Arguments, strings must stay alive until `co_await` returns
+    ///
+    template <typename... Args>
+    auto add(uint64_t tag, std::string_view name, Args&&... args) {
+        return impl_->add(impl::command_args(name, std::forward<Args>(args)...), tag);
+    }
+
+    /// @brief Write one prepared command, suspends while the window is full.
+    auto add(uint64_t tag, impl::command_args args) {
+        return impl_->add(std::move(args), tag);
+    }
+
+    /// @brief Wait for the replies of all written commands.
+    /// @return Final counters.
+    auto flush() { return impl_->flush(); }
+
+    /// @brief Called for every error reply, lost or unsent command.
+    void set_error_handler(
+        std::function<void(uint64_t tag, std::string_view err)> handler) {
+        impl_->set_error_handler(std::move(handler));
+    }
+
+    /// @brief Called every `bulk_options::progress_every` replies and when
+    ///   `flush` is done.
+    void set_progress_handler(std::function<void(const bulk_stats&)> handler) {
+        impl_->set_progress_handler(std::move(handler));
+    }
+
+    const bulk_stats& stats() const { return impl_->stats(); }
+
+    /// @brief Commands waiting for their reply.
+    size_t inflight() const { return impl_->inflight(); }
+
+  private:
+    impl::bulk_loader_impl* impl_;  // released, not deleted
+};  // class bulk_loader
+}  // namespace coro_redis
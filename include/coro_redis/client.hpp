@@ -10,9 +10,11 @@
 #include <hiredis/hiredis.h>
 #include <coro_redis/impl/client.ipp>
 #include <coro_redis/impl/task.ipp>
+#include <coro_redis/bulk_loader.hpp>
 #include <coro_redis/context.hpp>
 #include <coro_redis/coro_connection.hpp>
 #include <coro_redis/sync_connection.hpp>
+#include <coro_redis/when_all.hpp>
 
 namespace coro_redis {
 
@@ -23,6 +25,7 @@ class client final {
   public:
     using conn_awaiter_t = task_awaiter<std::shared_ptr<coro_connection>, const redisAsyncContext*>;
     using fetch_awaiter_t = task_awaiter<std::shared_ptr<coro_connection>>;
+    using ready_awaiter_t = task_awaiter<bool>;
     ///
     /// @brief singleton for get client
     ///
@@ -42,13 +45,16 @@ class client final {
     /// @param host Redis host name or IP
     /// @param port Reis listening port
     /// @param timeout Connecte and command timeout
+    /// @param protocol RESP3 negotiates `HELLO 3` (redis 6+), replies then
+    ///   come as native maps, sets, doubles and bools
     /// @return Corotine expression about connetion
     ///
     conn_awaiter_t coro_connect(const io_context& ioc,
                                 std::string_view host,
                                 uint16_t port,
-                                long timeout_seconds = 5) {
-        return impl_.coro_connect(ioc, host, port, timeout_seconds);
+                                long timeout_seconds = 5,
+                                RedisProtocol protocol = RedisProtocol::RESP2) {
+        return impl_.coro_connect(ioc, host, port, timeout_seconds, protocol);
     }
 
     ///
@@ -57,12 +63,14 @@ class client final {
     /// @param host Redis host name or IP
     /// @param port Reis listening port
     /// @param timeout Connecte and command timeout
+    /// @param protocol RESP3 negotiates `HELLO 3` (redis 6+)
     /// @return Redis synchronous connetion
     ///
     std::shared_ptr<sync_connection> sync_connect(std::string_view host_sv,
             uint16_t port,
-            long timeout_seconds = 5) {
-        return impl_.sync_connect(host_sv, port, timeout_seconds);
+            long timeout_seconds = 5,
+            RedisProtocol protocol = RedisProtocol::RESP2) {
+        return impl_.sync_connect(host_sv, port, timeout_seconds, protocol);
     }
 
     ///
@@ -70,15 +78,23 @@ class client final {
     ///
     /// @param pool_ios IO contexts, pool_ios's size
     ///		is the connection count in pool, the connection
-    ///   will be lazy initializated at use
+    ///   will be lazy initializated at use. Connections of the same
+    ///   io context form one shard with its own lock, a fetch looks at
+    ///   the caller's shard first and then steals from the others
     /// @param host Redis host name or IP
     /// @param port Reis listening port
     /// @param timeout Connecte and command timeout
+    /// @param protocol RESP3 negotiates `HELLO 3` (redis 6+)
+    /// @param opt Acquire timeout, waiter limit, stealing, credentials and
+    ///   warm-up. With `warm_up` every connection is opened right away
+    ///   instead of at first use, call it before the io contexts loop
     ///
     void pool_init(std::vector<io_context*> pool_ios,
                    std::string_view host_sv, uint16_t port,
-                   long timeout_seconds = 5) {
-        impl_.pool_init(pool_ios, host_sv, port, timeout_seconds);
+                   long timeout_seconds = 5,
+                   RedisProtocol protocol = RedisProtocol::RESP2,
+                   pool_options opt = {}) {
+        impl_.pool_init(pool_ios, host_sv, port, timeout_seconds, protocol, opt);
     }
 
     ///
@@ -88,14 +104,55 @@ class client final {
     ///		try create new connection if total connectin is not over max.
     ///		If connection pool is full and all connection are using this
     ///		function will suspend to wait untill a connection is recycaled.
+    ///		Waiters are served first come first served, a recycled
+    ///		connection is handed to the oldest one directly. The connection
+    ///		goes back to the pool when the last reference is released.
+    ///		With `pool_options::multiplex` nothing is checked out: every
+    ///		caller gets the least busy connection of its loop and commands
+    ///		of all callers are pipelined on it. Only callers running on a
+    ///		pool loop are served, others get nullptr, since a connection
+    ///		must only be used by the loop driving it. A connection is
+    ///		opened when the loop has none yet. MULTI/EXEC, blocking
+    ///		commands (BLPOP, ...) and SUBSCRIBE must not run on a shared
+    ///		connection, they stall or break the other callers.
     /// Example:
     /// @code{.cpp}
-    ///   auto conn_ret = co_await client::get().fetch_coro_conn();
-    ///   std::shared_ptr<coro_connection> conn = conn_ret.value();
+    ///   auto conn_ret = co_await client::get().fetch_coro_conn(&ioc, 100);
+    ///   ASSERT_CO_RETURN(conn_ret != nullptr, false, "pool busy");
+    /// @endcode
+    /// @param ioc Loop the calling coroutine runs on, selects the shard
+    ///		and arms the timeout; nullptr uses `io_context::current()`.
+    ///		With `pool_options::thread_affine` a caller on a pool loop only
+    ///		gets connections attached to that loop
+    /// @param timeout_ms Wait at most this long, -1 uses
+    ///		`pool_options::acquire_timeout_ms`, 0 waits forever
+    /// @return nullptr on timeout, when too many coroutines wait, or if
+    ///		connecting failed
+    ///
+    fetch_awaiter_t fetch_coro_conn(const io_context* ioc = nullptr,
+                                    long timeout_ms = -1) {
+        return impl_.fetch_coro_conn(ioc, timeout_ms);
+    }
+
+    ///
+    /// @brief Wait until the connections opened by a warm-up pool_init
+    ///   answered a PING, i.e. finished AUTH, SELECT and HELLO as well
+    ///
+    /// Example:
+    /// @code{.cpp}
+    ///   bool warm = co_await client::get().ready();
+    ///   ASSERT_CO_RETURN(warm, false, "redis pool is not healthy");
+    ///   start_listening();
     /// @endcode
+    /// @return false if any connection failed, it is retried at next fetch
     ///
-    fetch_awaiter_t fetch_coro_conn() {
-        return impl_.fetch_coro_conn();
+    ready_awaiter_t ready() {
+        return impl_.ready();
+    }
+
+    /// @brief Coroutines waiting for a pooled connection.
+    size_t pool_waiting() {
+        return impl_.waiting();
     }
 
     ///
@@ -2,9 +2,45 @@
 
 namespace coro_redis {
 struct io_context {
+    using timer_fn = void (*)(void* arg);
+
     virtual int attach(redisAsyncContext* actx) const = 0;
     virtual void loop() const = 0;
     virtual void exit() const = 0;
+
+    ///
+    /// @brief Call `fn(arg)` once on this loop after `ms` milliseconds.
+    ///
+    /// @return Handle for `cancel_timer`, nullptr if the context has no
+    ///   timers. The handle is released when the timer fires.
+    ///
+    virtual void* add_timer(long ms, timer_fn fn, void* arg) const {
+        return nullptr;
+    }
+
+    /// @brief Cancel a timer which has not fired yet, on the loop thread.
+    virtual void cancel_timer(void* timer) const {}
+
+    /// @brief The context whose `loop()` runs on the calling thread,
+    ///   nullptr outside of any loop.
+    static const io_context* current() { return current_; }
+
+  protected:
+    /// Marks the context as current while `loop()` runs, implementations
+    /// of `loop()` should hold one.
+    class current_scope {
+      public:
+        explicit current_scope(const io_context* ioc) : prev_(current_) {
+            current_ = ioc;
+        }
+        ~current_scope() { current_ = prev_; }
+
+      private:
+        const io_context* prev_;
+    };
+
+  private:
+    static inline thread_local const io_context* current_ = nullptr;
 };
 
 #ifdef __HIREDIS_LIBEVENT_H__
@@ -20,6 +56,7 @@ class libevent_io_context : public io_context {
     }
 
     virtual void loop() const override {
+        current_scope scope(this);
         event_base_dispatch(base_);
     }
 
@@ -27,7 +64,32 @@ class libevent_io_context : public io_context {
         event_base_loopexit(base_, nullptr);
     }
 
+    virtual void* add_timer(long ms, timer_fn fn, void* arg) const override {
+        auto* t = new timer{nullptr, fn, arg};
+        t->ev = evtimer_new(base_, [](evutil_socket_t, short, void* p) {
+            auto* t = (timer*)p;
+            t->fn(t->arg);
+            event_free(t->ev);
+            delete t;
+        }, t);
+        timeval tv{ms / 1000, (ms % 1000) * 1000};
+        evtimer_add(t->ev, &tv);
+        return t;
+    }
+
+    virtual void cancel_timer(void* handle) const override {
+        auto* t = (timer*)handle;
+        event_free(t->ev);
+        delete t;
+    }
+
   private:
+    struct timer {
+        event* ev;
+        timer_fn fn;
+        void* arg;
+    };
+
     event_base* base_ = nullptr;
 };
 #endif
@@ -46,10 +108,42 @@ class libuv_io_context : public io_context {
         return redisLibuvAttach(actx, loop_);
     }
 
-    virtual void loop() const override { uv_run(loop_, UV_RUN_DEFAULT); }
+    virtual void loop() const override {
+        current_scope scope(this);
+        uv_run(loop_, UV_RUN_DEFAULT);
+    }
 
     virtual void exit() const override { uv_stop(loop_); }
+
+    virtual void* add_timer(long ms, timer_fn fn, void* arg) const override {
+        auto* t = new timer{{}, fn, arg};
+        uv_timer_init(loop_, &t->handle);
+        t->handle.data = t;
+        uv_timer_start(&t->handle, [](uv_timer_t* h) {
+            auto* t = (timer*)h->data;
+            t->fn(t->arg);
+            close(t);
+        }, ms, 0);
+        return t;
+    }
+
+    virtual void cancel_timer(void* handle) const override {
+        auto* t = (timer*)handle;
+        uv_timer_stop(&t->handle);
+        close(t);
+    }
   private:
+    struct timer {
+        uv_timer_t handle;
+        timer_fn fn;
+        void* arg;
+    };
+
+    static void close(timer* t) {
+        uv_close((uv_handle_t*)&t->handle,
+                 [](uv_handle_t* h) { delete (timer*)h->data; });
+    }
+
     uv_loop_t* loop_ = nullptr;
 };
 #endif
@@ -7,16 +7,30 @@
 //
 #pragma once
 
-#include <fmt/format.h>
-
 #include <coro_redis/impl/coro_connection.ipp>
+#include <coro_redis/impl/pipeline.ipp>
 
 namespace coro_redis {
 
+namespace impl {
+class bulk_loader_impl;
+class client_impl;
+}  // namespace impl
+
 class sync_connection;
 ///
 /// @brief connection of corotine
 ///
+/// Commands are pipelined automatically: a command is queued when its
+/// awaiter suspends and written when the event loop polls the socket, so
+/// every command issued by any coroutine in the same loop iteration goes out
+/// in one write, and replies are routed back to their awaiters in order.
+/// Many coroutines may await on one connection at the same time.
+///
+/// String arguments are borrowed until the command is `co_await`ed, only
+/// temporary `std::string`s given to `command_argv` or as `set` value are
+/// kept by the awaiter. Store an awaiter only together with its strings.
+///
 class coro_connection {
   public:
     using cptr = std::shared_ptr<coro_connection>;
@@ -25,12 +39,54 @@ class coro_connection {
     /// @brief construction
     ///
     /// @param actx Redis asynchronous context
+    /// @param protocol RESP3 sends `HELLO 3` before any other command
+    ///
+    coro_connection(redisAsyncContext* actx,
+                    RedisProtocol protocol = RedisProtocol::RESP2)
+        : impl_(actx, protocol) {}
+
+    ///
+    /// @brief construction, authenticating and selecting a database
+    ///
+    /// @param actx Redis asynchronous context
+    /// @param protocol RESP3 sends `HELLO 3` before any other command
+    /// @param user ACL user name, empty for the default user
+    /// @param password `AUTH` is sent first if it is not empty
+    /// @param db `SELECT` is sent if it is not 0
     ///
-    coro_connection(redisAsyncContext* actx) : impl_(actx) {}
+    coro_connection(redisAsyncContext* actx, RedisProtocol protocol,
+                    std::string_view user, std::string_view password,
+                    int db = 0)
+        : impl_(actx, protocol, user, password, db) {}
+
+    /// @brief Protocol requested for this connection.
+    RedisProtocol protocol() const { return impl_.protocol(); }
+
+    /// @brief Handle RESP3 push messages, e.g. invalidations of
+    ///   `CLIENT TRACKING`. The view is valid during the call only.
+    void set_push_handler(std::function<void(reply_view)> handler) {
+        impl_.set_push_handler(std::move(handler));
+    }
+
+    /// @brief Number of commands sent and still waiting for their reply,
+    ///   i.e. the current pipeline depth.
+    size_t pending() const { return impl_.pending(); }
+
+    /// @brief Start a batch of typed commands awaited together, see
+    ///   `impl::pipeline_awaiter`. String arguments must stay alive until
+    ///   the batch is `co_await`ed, temporary `std::string`s are kept.
+    ///
+    /// Example:
+    /// @code{.cpp}
+    ///   auto [val, len] = co_await conn->pipeline()
+    ///       .command<std::string>("get", "key")
+    ///       .command<uint64_t>("llen", "list");
+    /// @endcode
+    pipeline_t<> pipeline() const { return pipeline_t<>(&impl_); }
 
 
     /// @brief Send redis command.
-    /// @param cmd Redis command.
+    /// @param cmd Redis command, arguments are separated by whitespace.
     /// @return Redis return.
     template <typename CORO_RET = std::string>
     awaiter_t<CORO_RET> command(std::string_view cmd) const {
@@ -38,14 +94,31 @@ class coro_connection {
     }
 
     /// @brief Send redis command.
-    /// @param cmd Redis command.
+    /// @param cmd Redis command, arguments are separated by whitespace.
     /// @param reply_op Callback for deal redis reply.
     /// @return Redis return.
     template <typename CORO_RET>
     awaiter_t<CORO_RET> command(
         std::string_view cmd,
         std::function<std::optional<CORO_RET>(redisReply*)>&& reply_op) const {
-        return impl_.command<CORO_RET>(cmd, reply_op);
+        return impl_.command<CORO_RET>(cmd, std::move(reply_op));
+    }
+
+    /// @brief Send redis command with binary safe arguments.
+    ///
+    /// Example:
+    /// @code{.cpp}
+    ///   co_await conn->command_argv<std::string>("set", "key", "value with space");
+    /// @endcode
+    /// @param name Command name.
+    /// @param args Arguments, strings or numbers, each one is sent as it is.
+    /// @return Redis return.
+    /// @note Use `reply_view` as return type to read the reply without
+    ///   copying it.
+    template <typename CORO_RET = std::string, typename... Args>
+    awaiter_t<CORO_RET> command_argv(std::string_view name,
+                                     Args&&... args) const {
+        return impl_.command_argv<CORO_RET>(name, std::forward<Args>(args)...);
     }
 
     /// @brief Send password to Redis.
@@ -54,7 +127,7 @@ class coro_connection {
     ///       Instead, you should set password with `ConnectionOptions` or URI.
     /// @see https://redis.io/commands/auth
     inline awaiter_t<std::string> auth(std::string_view password) {
-        return impl_.command<std::string>(fmt::format("auth {}", password));
+        return impl_.command_argv<std::string, "auth">(password);
     }
 
     /// @brief Send user and password to Redis.
@@ -66,8 +139,7 @@ class coro_connection {
     /// @see https://redis.io/commands/auth
     inline awaiter_t<std::string> auth(std::string_view user,
                                        std::string_view password) {
-        return impl_.command<std::string>(
-                   fmt::format("auth {} {}", user, password));
+        return impl_.command_argv<std::string, "auth">(user, password);
     }
 
     /// @brief Ask Redis to return the given message.
@@ -75,14 +147,14 @@ class coro_connection {
     /// @return Return the given message.
     /// @see https://redis.io/commands/echo
     inline awaiter_t<std::string> echo(std::string_view msg) const {
-        return impl_.command<std::string>(fmt::format("echo {}", msg));
+        return impl_.command_argv<std::string, "echo">(msg);
     }
 
     /// @brief Test if the connection is alive.
     /// @return Always return *PONG*.
     /// @see https://redis.io/commands/ping
     inline awaiter_t<std::string> ping() {
-        return impl_.command<std::string>("ping");
+        return impl_.command_argv<std::string, "ping">();
     }
 
     /// @brief Test if the connection is alive.
@@ -90,20 +162,20 @@ class coro_connection {
     /// @return Return the given message.
     /// @see https://redis.io/commands/ping
     inline awaiter_t<std::string> ping(std::string_view msg) {
-        return impl_.command<std::string>(fmt::format("ping {}", msg));
+        return impl_.command_argv<std::string, "ping">(msg);
     }
 
     /// @brief After sending QUIT, only the current connection will be close,
     /// while other connections in the pool is still open.
     /// @see https://redis.io/commands/quit
     inline awaiter_t<std::string> quit() {
-        return impl_.command<std::string>(fmt::format("quit"));
+        return impl_.command_argv<std::string, "quit">();
     }
 
     /// @brief Select the Redis logical database
     /// @see https://redis.io/commands/select
     inline awaiter_t<std::string> select(uint64_t idx) {
-        return impl_.command<std::string>(fmt::format("select {}", idx));
+        return impl_.command_argv<std::string, "select">(idx);
     }
 
     /// @brief Swap two Redis databases.
@@ -111,7 +183,7 @@ class coro_connection {
     /// @param idx2 The index of the second database.
     /// @see https://redis.io/commands/swapdb
     inline awaiter_t<std::string> swapdb(uint64_t idx1, uint64_t idx2) {
-        return impl_.command<std::string>(fmt::format("swapdb {} {}", idx1, idx2));
+        return impl_.command_argv<std::string, "swapdb">(idx1, idx2);
     }
 
     // SERVER commands.
@@ -119,20 +191,20 @@ class coro_connection {
     /// @brief Rewrite AOF in the background.
     /// @see https://redis.io/commands/bgrewriteaof
     inline awaiter_t<std::string> bgrewriteaof() {
-        return impl_.command<std::string>("bgrewriteaof");
+        return impl_.command_argv<std::string, "bgrewriteaof">();
     }
 
     /// @brief Save database in the background.
     /// @see https://redis.io/commands/bgsave
     inline awaiter_t<std::string> bgsave() {
-        return impl_.command<std::string>("bgsave");
+        return impl_.command_argv<std::string, "bgsave">();
     }
 
     /// @brief Get the size of the currently selected database.
     /// @return Number of keys in currently selected database.
     /// @see https://redis.io/commands/dbsize
     inline awaiter_t<uint64_t> dbsize() {
-        return impl_.command<uint64_t>("dbsize");
+        return impl_.command_argv<uint64_t, "dbsize">();
     }
 
     /// @brief Remove keys of all databases.
@@ -140,8 +212,7 @@ class coro_connection {
     /// blocking the server.
     /// @see https://redis.io/commands/flushall
     inline awaiter_t<std::string> flushall(bool async = false) {
-        return impl_.command<std::string>(async ? "FLUSHALL ASYNC"
-                                          : "FLUSHALL SYNC");
+        return impl_.command_argv<std::string, "flushall">(async ? "ASYNC" : "SYNC");
     }
 
     /// @brief Remove keys of current databases.
@@ -149,14 +220,14 @@ class coro_connection {
     /// blocking the server.
     /// @see https://redis.io/commands/flushdb
     inline awaiter_t<std::string> flushdb(bool async = false) {
-        return impl_.command<std::string>(async ? "FLUSHDB ASYNC" : "FLUSHDB SYNC");
+        return impl_.command_argv<std::string, "flushdb">(async ? "ASYNC" : "SYNC");
     }
 
     /// @brief Get the info about the server.
     /// @return Server info.
     /// @see https://redis.io/commands/info
     inline awaiter_t<std::string> info() {
-        return impl_.command<std::string>("info");
+        return impl_.command_argv<std::string, "info">();
     }
 
     /// @brief Get the info about the server on the given section.
@@ -164,7 +235,7 @@ class coro_connection {
     /// @return Server info.
     /// @see https://redis.io/commands/info
     inline awaiter_t<std::string> info(std::string_view section) {
-        return impl_.command<std::string>(fmt::format("info {}", section));
+        return impl_.command_argv<std::string, "info">(section);
     }
 
     /// @brief Get the UNIX timestamp in seconds, at which the database was saved
@@ -172,14 +243,14 @@ class coro_connection {
     /// @return The last saving time.
     /// @see https://redis.io/commands/lastsave
     inline awaiter_t<uint64_t> lastsave() {
-        return impl_.command<uint64_t>("lastsave");
+        return impl_.command_argv<uint64_t, "lastsave">();
     }
 
     /// @brief Save databases into RDB file **synchronously**, i.e. block the
     /// server during saving.
     /// @see https://redis.io/commands/save
     inline awaiter_t<std::string> save() {
-        return impl_.command<std::string>("save");
+        return impl_.command_argv<std::string, "save">();
     }
 
     // KEY commands.
@@ -192,9 +263,17 @@ class coro_connection {
     /// @see https://redis.io/commands/del
     template <typename... Args>
     inline awaiter_t<uint64_t> del(Args&&... keys) {
-        std::string cmd("del");
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "del">(keys...);
+    }
+
+    /// @brief Delete every key of the given range.
+    /// @param keys Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/del
+    template <RedisKeyRange R>
+    inline awaiter_t<uint64_t> del(R&& keys) {
+        impl::command_args args("del");
+        args.append_range(keys);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Get the serialized valued stored at key.
@@ -204,7 +283,7 @@ class coro_connection {
     /// (`std::nullopt`).
     /// @see https://redis.io/commands/dump
     inline awaiter_t<std::string> dump(std::string_view key) {
-        return impl_.command<std::string>(fmt::format("dump {}", key));
+        return impl_.command_argv<std::string, "dump">(key);
     }
 
     /// @brief Check if the given key exists.
@@ -215,9 +294,17 @@ class coro_connection {
     /// @see https://redis.io/commands/exists
     template <typename... Args>
     inline awaiter_t<uint64_t> exists(Args&&... keys) {
-        std::string cmd("exists");
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "exists">(keys...);
+    }
+
+    /// @brief Count how many keys of the given range exist.
+    /// @param keys Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/exists
+    template <RedisKeyRange R>
+    inline awaiter_t<uint64_t> exists(R&& keys) {
+        impl::command_args args("exists");
+        args.append_range(keys);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Set a timeout on key.
@@ -228,7 +315,7 @@ class coro_connection {
     /// @retval 0 If key does not exist.
     /// @see https://redis.io/commands/expire
     inline awaiter_t<uint64_t> expire(std::string_view key, uint64_t timeout) {
-        return impl_.command<uint64_t>(fmt::format("expire {} {}", key, timeout));
+        return impl_.command_argv<uint64_t, "expire">(key, timeout);
     }
 
     /// @brief Set a timeout on key, i.e. expire the key at a future time point.
@@ -240,8 +327,7 @@ class coro_connection {
     /// @see https://redis.io/commands/expireat
     inline awaiter_t<uint64_t> expireat(std::string_view key,
                                         uint64_t timestamp) {
-        return impl_.command<uint64_t>(
-                   fmt::format("expireat {} {}", key, timestamp));
+        return impl_.command_argv<uint64_t, "expireat">(key, timestamp);
     }
 
     /// @brief Get keys matching the given pattern.
@@ -254,8 +340,7 @@ class coro_connection {
     /// @see `Redis::scan`
     /// @see https://redis.io/commands/keys
     // inline awaiter_t<std::vector<std::string>> keys(std::string_view pattern) {
-    //	return impl_.command<std::vector<std::string>>(fmt::format("keys {}",
-    //pattern));
+    //	return impl_.command_argv<std::vector<std::string>, "keys">(pattern);
     //}
 
     /// @brief Move a key to the given database.
@@ -266,7 +351,7 @@ class coro_connection {
     /// @retval false If key was not moved.
     /// @see https://redis.io/commands/move
     inline awaiter_t<uint64_t> move(std::string_view key, uint64_t db) {
-        return impl_.command<uint64_t>(fmt::format("move {} {}", key, db));
+        return impl_.command_argv<uint64_t, "move">(key, db);
     }
 
     /// @brief Remove timeout on key.
@@ -277,7 +362,7 @@ class coro_connection {
     /// timeout.
     /// @see https://redis.io/commands/persist
     inline awaiter_t<uint64_t> persist(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("persist {}", key));
+        return impl_.command_argv<uint64_t, "persist">(key);
     }
 
     /// @brief Set a timeout on key.
@@ -288,7 +373,7 @@ class coro_connection {
     /// @retval false If key does not exist.
     /// @see https://redis.io/commands/pexpire
     inline awaiter_t<uint64_t> pexpire(std::string_view key, uint64_t timeout) {
-        return impl_.command<uint64_t>(fmt::format("pexpire {} {}", key, timeout));
+        return impl_.command_argv<uint64_t, "pexpire">(key, timeout);
     }
 
     /// @brief Set a timeout on key, i.e. expire the key at a future time point.
@@ -300,8 +385,7 @@ class coro_connection {
     /// @see https://redis.io/commands/pexpireat
     inline awaiter_t<uint64_t> pexpireat(std::string_view key,
                                          uint64_t timestamp) {
-        return impl_.command<uint64_t>(
-                   fmt::format("pexpireat {} {}", key, timestamp));
+        return impl_.command_argv<uint64_t, "pexpireat">(key, timestamp);
     }
 
     /// @brief Get the TTL of a key in milliseconds.
@@ -309,7 +393,7 @@ class coro_connection {
     /// @return TTL of the key in milliseconds.
     /// @see https://redis.io/commands/pttl
     inline awaiter_t<uint64_t> pttl(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("pttl {}", key));
+        return impl_.command_argv<uint64_t, "pttl">(key);
     }
 
     /// @brief Get a random key from current database.
@@ -318,7 +402,7 @@ class coro_connection {
     /// (`std::nullopt`).
     /// @see https://redis.io/commands/randomkey
     inline awaiter_t<std::string> randomkey() {
-        return impl_.command<std::string>("randomkey");
+        return impl_.command_argv<std::string, "randomkey">();
     }
 
     /// @brief Rename `key` to `newkey`.
@@ -327,7 +411,7 @@ class coro_connection {
     /// @see https://redis.io/commands/rename
     inline awaiter_t<std::string> rename(std::string_view key,
                                          std::string_view newkey) {
-        return impl_.command<std::string>(fmt::format("rename {} {}", key, newkey));
+        return impl_.command_argv<std::string, "rename">(key, newkey);
     }
 
     /// @brief Rename `key` to `newkey` if `newkey` does not exist.
@@ -339,7 +423,7 @@ class coro_connection {
     /// @see https://redis.io/commands/renamenx
     inline awaiter_t<uint64_t> renamenx(std::string_view key,
                                         std::string_view newkey) {
-        return impl_.command<uint64_t>(fmt::format("renamenx {} {}", key, newkey));
+        return impl_.command_argv<uint64_t, "renamenx">(key, newkey);
     }
 
     /// @brief Create a key with the value obtained by `Redis::dump`.
@@ -354,8 +438,9 @@ class coro_connection {
     inline awaiter_t<std::string> restore(std::string_view key,
                                           std::string_view val, uint64_t ttl,
                                           bool replace = false) {
-        return impl_.command<std::string>(
-                   fmt::format("restore {} {} {} {}", key, ttl, val, replace));
+        impl::command_args args("restore", key, ttl, val);
+        if (replace) args.append("REPLACE");
+        return impl_.command<std::string>(std::move(args));
     }
 
     // TODO: sort
@@ -391,9 +476,17 @@ class coro_connection {
     /// @see https://redis.io/commands/touch
     template <typename... Args>
     inline awaiter_t<uint64_t> touch(Args&&... keys) {
-        std::string cmd("touch");
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "touch">(keys...);
+    }
+
+    /// @brief Update the last access time of every key of the given range.
+    /// @param keys Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/touch
+    template <RedisKeyRange R>
+    inline awaiter_t<uint64_t> touch(R&& keys) {
+        impl::command_args args("touch");
+        args.append_range(keys);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Get the remaining Time-To-Live of a key.
@@ -406,7 +499,7 @@ class coro_connection {
     ///       or if the key exists but does not have a timeout.
     /// @see https://redis.io/commands/ttl
     inline awaiter_t<uint64_t> ttl(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("ttl {}", key));
+        return impl_.command_argv<uint64_t, "ttl">(key);
     }
 
     /// @brief Get the type of the value stored at key.
@@ -414,7 +507,7 @@ class coro_connection {
     /// @return The type of the value.
     /// @see https://redis.io/commands/type
     inline awaiter_t<std::string> type(std::string_view key) {
-        return impl_.command<std::string>(fmt::format("type {}", key));
+        return impl_.command_argv<std::string, "type">(key);
     }
 
     /// @brief Remove the given key asynchronously, i.e. without blocking Redis.
@@ -425,9 +518,17 @@ class coro_connection {
     /// @see https://redis.io/commands/unlink
     template <typename... Args>
     inline awaiter_t<uint64_t> unlink(Args&&... keys) {
-        std::string cmd("unlink");
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "unlink">(keys...);
+    }
+
+    /// @brief Remove every key of the given range in a background thread.
+    /// @param keys Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/unlink
+    template <RedisKeyRange R>
+    inline awaiter_t<uint64_t> unlink(R&& keys) {
+        impl::command_args args("unlink");
+        args.append_range(keys);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Wait until previous write commands are successfully replicated to
@@ -442,8 +543,7 @@ class coro_connection {
     /// been reached.
     /// @see https://redis.io/commands/wait
     inline awaiter_t<uint64_t> wait(uint64_t numslaves, uint64_t timeout) {
-        return impl_.command<uint64_t>(
-                   fmt::format("wait {} {}", numslaves, timeout));
+        return impl_.command_argv<uint64_t, "wait">(numslaves, timeout);
     }
 
     // STRING commands.
@@ -455,7 +555,7 @@ class coro_connection {
     /// @see https://redis.io/commands/append
     inline awaiter_t<uint64_t> append(std::string_view key,
                                       std::string_view str) {
-        return impl_.command<uint64_t>(fmt::format("append {} {}", key, str));
+        return impl_.command_argv<uint64_t, "append">(key, str);
     }
 
     /// @brief Get the number of bits that have been set for the given range of
@@ -470,8 +570,7 @@ class coro_connection {
     /// @see https://redis.io/commands/bitcount
     inline awaiter_t<uint64_t> bitcount(std::string_view key, uint64_t start = 0,
                                         uint64_t end = -1) {
-        return impl_.command<uint64_t>(
-                   fmt::format("bitcount {} {} {}", key, start, end));
+        return impl_.command_argv<uint64_t, "bitcount">(key, start, end);
     }
 
     enum BitOp { AND, OR, XOR, NOT };
@@ -485,23 +584,8 @@ class coro_connection {
     /// @see `BitOp`
     template <typename... Args>
     inline awaiter_t<uint64_t> bitop(BitOp op, Args&&... keys) {
-        std::string cmd("bitop");
-        switch (op) {
-        case BitOp::AND:
-            cmd.append(" AND ");
-            break;
-        case BitOp::OR:
-            cmd.append(" OR ");
-            break;
-        case BitOp::XOR:
-            cmd.append(" XOR ");
-            break;
-        case BitOp::NOT:
-            cmd.append(" NOT ");
-            break;
-        }
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        constexpr std::string_view ops[] = {"AND", "OR", "XOR", "NOT"};
+        return impl_.command_argv<uint64_t, "bitop">(ops[op], keys...);
     }
 
     /// @brief Get the position of the first bit set to 0 or 1 in the given range
@@ -516,8 +600,7 @@ class coro_connection {
     /// @see https://redis.io/commands/bitpos
     inline awaiter_t<uint64_t> bitpos(std::string_view key, uint64_t bit,
                                       uint64_t start = 0, uint64_t end = -1) {
-        return impl_.command<uint64_t>(
-                   fmt::format("bitpos {} {} {} {}", key, bit, start, end));
+        return impl_.command_argv<uint64_t, "bitpos">(key, bit, start, end);
     }
 
     /// @brief Decrement the integer stored at key by 1.
@@ -525,7 +608,7 @@ class coro_connection {
     /// @return The value after the decrement.
     /// @see https://redis.io/commands/decr
     inline awaiter_t<uint64_t> decr(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("decr {}", key));
+        return impl_.command_argv<uint64_t, "decr">(key);
     }
 
     /// @brief Decrement the integer stored at key by `decrement`.
@@ -534,7 +617,7 @@ class coro_connection {
     /// @return The value after the decrement.
     /// @see https://redis.io/commands/decrby
     inline awaiter_t<uint64_t> decrby(std::string_view key, uint64_t decrement) {
-        return impl_.command<uint64_t>(fmt::format("decrby {} {}", key, decrement));
+        return impl_.command_argv<uint64_t, "decrby">(key, decrement);
     }
 
     /// @brief Get the string value stored at key.
@@ -553,7 +636,7 @@ class coro_connection {
     /// (`std::nullopt`).
     /// @see https://redis.io/commands/get
     inline awaiter_t<std::string> get(std::string_view key) const {
-        return impl_.command<std::string>(fmt::format("get {}", key));
+        return impl_.command_argv<std::string, "get">(key);
     }
 
     /// @brief Get the bit value at offset in the string.
@@ -562,7 +645,7 @@ class coro_connection {
     /// @return The bit value.
     /// @see https://redis.io/commands/getbit
     inline awaiter_t<uint64_t> getbit(std::string_view key, uint64_t offset) {
-        return impl_.command<uint64_t>(fmt::format("getbit {} {}", key, offset));
+        return impl_.command_argv<uint64_t, "getbit">(key, offset);
     }
 
     /// @brief Get the substring of the string stored at key.
@@ -576,8 +659,7 @@ class coro_connection {
     /// @see https://redis.io/commands/getrange
     inline awaiter_t<std::string> getrange(std::string_view key, uint64_t start,
                                            uint64_t end) {
-        return impl_.command<std::string>(
-                   fmt::format("getrange {} {} {}", key, start, end));
+        return impl_.command_argv<std::string, "getrange">(key, start, end);
     }
 
     /// @brief Atomically set the string stored at `key` to `val`, and return the
@@ -591,7 +673,7 @@ class coro_connection {
     /// @see `OptionalString`
     inline awaiter_t<std::string> getset(std::string_view key,
                                          std::string_view val) {
-        return impl_.command<std::string>(fmt::format("getset {} {}", key, val));
+        return impl_.command_argv<std::string, "getset">(key, val);
     }
 
     /// @brief Increment the integer stored at key by 1.
@@ -599,7 +681,7 @@ class coro_connection {
     /// @return The value after the increment.
     /// @see https://redis.io/commands/incr
     inline awaiter_t<uint64_t> incr(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("incr {}", key));
+        return impl_.command_argv<uint64_t, "incr">(key);
     }
 
     /// @brief Increment the integer stored at key by `increment`.
@@ -608,7 +690,7 @@ class coro_connection {
     /// @return The value after the increment.
     /// @see https://redis.io/commands/incrby
     inline awaiter_t<uint64_t> incrby(std::string_view key, uint64_t increment) {
-        return impl_.command<uint64_t>(fmt::format("incrby {} {}", key, increment));
+        return impl_.command_argv<uint64_t, "incrby">(key, increment);
     }
 
     /// @brief Increment the floating point number stored at key by `increment`.
@@ -618,8 +700,7 @@ class coro_connection {
     /// @see https://redis.io/commands/incrbyfloat
     inline awaiter_t<std::string> incrbyfloat(std::string_view key,
             double increment) {
-        return impl_.command<std::string>(
-                   fmt::format("incrby {} {}", key, increment));
+        return impl_.command_argv<std::string, "incrbyfloat">(key, increment);
     }
 
     /// @brief Get the values of multiple keys atomically.
@@ -644,11 +725,19 @@ class coro_connection {
     ///       since the given key might not exist (in this case, the value of the
     ///       corresponding key is `OptionalString{}` (`std::nullopt`)).
     /// @see https://redis.io/commands/mget
-    template <typename... Args>
-    inline awaiter_t<std::vector<std::string>> mget(Args&&... keys) {
-        std::string cmd("mget");
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<std::vector<std::string>>(std::move(cmd));
+    template <typename T = std::vector<std::string>, typename... Args>
+    inline awaiter_t<T> mget(Args&&... keys) {
+        return impl_.command_argv<T, "mget">(keys...);
+    }
+
+    /// @brief Get the values of every key of the given range.
+    /// @param keys Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/mget
+    template <typename T = std::vector<std::string>, RedisKeyRange R>
+    inline awaiter_t<T> mget(R&& keys) {
+        impl::command_args args("mget");
+        args.append_range(keys);
+        return impl_.command<T>(std::move(args));
     }
 
     /// @brief Set multiple key-value pairs.
@@ -663,9 +752,17 @@ class coro_connection {
     // requires requires (Args&&...keys) {	((std::string_view(keys)), ...);
     // }
     inline awaiter_t<std::string> mset(Args&&... keys) {
-        std::string cmd("mset");
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<std::string>(std::move(cmd));
+        return impl_.command_argv<std::string, "mset">(keys...);
+    }
+
+    /// @brief Set every key-value pair of the given range.
+    /// @param kvs Sized range, e.g. `std::vector` or `std::span` of pairs.
+    /// @see https://redis.io/commands/mset
+    template <RedisPairRange R>
+    inline awaiter_t<std::string> mset(R&& kvs) {
+        impl::command_args args("mset");
+        args.append_range(kvs);
+        return impl_.command<std::string>(std::move(args));
     }
 
     /// @brief Set the given key-value pairs if all specified keys do not exist.
@@ -687,9 +784,17 @@ class coro_connection {
     // requires requires (Args&&...keys) {	((std::string_view(keys)), ...);
     // }
     inline awaiter_t<std::string> msetnx(Args&&... keys) {
-        std::string cmd("msetnx");
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<std::string>(std::move(cmd));
+        return impl_.command_argv<std::string, "msetnx">(keys...);
+    }
+
+    /// @brief Set every key-value pair of the given range if none of the keys exist.
+    /// @param kvs Sized range, e.g. `std::vector` or `std::span` of pairs.
+    /// @see https://redis.io/commands/msetnx
+    template <RedisPairRange R>
+    inline awaiter_t<std::string> msetnx(R&& kvs) {
+        impl::command_args args("msetnx");
+        args.append_range(kvs);
+        return impl_.command<std::string>(std::move(args));
     }
 
     /// @brief Set key-value pair with the given timeout in milliseconds.
@@ -699,8 +804,7 @@ class coro_connection {
     /// @see https://redis.io/commands/psetex
     inline awaiter_t<std::string> psetex(std::string_view key, uint64_t ttl,
                                          std::string_view val) {
-        return impl_.command<std::string>(
-                   fmt::format("psetex {} {} {}", key, ttl, val));
+        return impl_.command_argv<std::string, "psetex">(key, ttl, val);
     }
 
     /// @brief Set a key-value pair.
@@ -719,7 +823,7 @@ class coro_connection {
     ///     std::cout << "key does not exist" << std::endl;
     /// @endcode
     /// @param key Key.
-    /// @param val Value.
+    /// @param val Value, a temporary `std::string` is kept by the awaiter.
     /// @param ttl Timeout on the key. If `ttl` is 0ms, do not set timeout.
     /// @param type Options for set command:
     ///             - UpdateType::EXIST: Set the key only if it already exists.
@@ -732,12 +836,13 @@ class coro_connection {
     /// @retval false If the key was not set, because of the given option.
     /// @see https://redis.io/commands/set
     // TODO: Support KEEPTTL option for Redis 6.0
-    template <RedisSetValueType T>
-    inline awaiter_t<std::string> set(std::string_view key, T val,
+    template <typename T>
+        requires RedisSetValueType<std::remove_cvref_t<T>>
+    inline awaiter_t<std::string> set(std::string_view key, T&& val,
                                       uint64_t ttl = 0,
                                       RedisTTLType ttl_type = RedisTTLType::EX,
                                       UpdateType type = UpdateType::ALWAYS) {
-        return impl_.set(key, val, ttl, ttl_type, type);
+        return impl_.set(key, std::forward<T>(val), ttl, ttl_type, type);
     }
 
     // TODO: add SETBIT command.
@@ -749,8 +854,7 @@ class coro_connection {
     /// @see https://redis.io/commands/setex
     inline awaiter_t<std::string> setex(std::string_view key, uint64_t ttl,
                                         std::string_view val) {
-        return impl_.command<std::string>(
-                   fmt::format("setex {} {} {}", key, ttl, val));
+        return impl_.command_argv<std::string, "setex">(key, ttl, val);
     }
 
     /// @brief Set the key if it does not exist.
@@ -761,7 +865,7 @@ class coro_connection {
     /// @retval false If the key was not set, i.e. the key already exists.
     /// @see https://redis.io/commands/setnx
     inline awaiter_t<uint64_t> setnx(std::string_view key, std::string_view val) {
-        return impl_.command<uint64_t>(fmt::format("setnx {} {}", key, val));
+        return impl_.command_argv<uint64_t, "setnx">(key, val);
     }
 
     /// @brief Set the substring starting from `offset` to the given value.
@@ -772,8 +876,7 @@ class coro_connection {
     /// @see https://redis.io/commands/setrange
     inline awaiter_t<uint64_t> setrange(std::string_view key, uint64_t offset,
                                         std::string_view val) {
-        return impl_.command<uint64_t>(
-                   fmt::format("setrange {} {} {}", key, offset, val));
+        return impl_.command_argv<uint64_t, "setrange">(key, offset, val);
     }
 
     /// @brief Get the length of the string stored at key.
@@ -782,7 +885,7 @@ class coro_connection {
     /// @note If key does not exist, `strlen` returns 0.
     /// @see https://redis.io/commands/strlen
     inline awaiter_t<uint64_t> strlen(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("strlen {}", key));
+        return impl_.command_argv<uint64_t, "strlen">(key);
     }
     /*
             // LIST commands.
@@ -797,8 +900,7 @@ class coro_connection {
             /// @see https://redis.io/commands/blpop
             inline awaiter_t<std::vector<std::string>> blpop(std::string_view key,
        uint64_t timeout = 0) { return
-       impl_.command<std::vector<std::string>>(fmt::format("blpop {} {}", key,
-       timeout));
+       impl_.command_argv<std::vector<std::string>, "blpop">(key, timeout);
             }
 
             /// @brief Pop the first element of the list in a blocking way.
@@ -1014,7 +1116,7 @@ class coro_connection {
     /// @return The length of the list.
     /// @see https://redis.io/commands/llen
     inline awaiter_t<uint64_t> llen(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("llen {}", key));
+        return impl_.command_argv<uint64_t, "llen">(key);
     }
 
     /// @brief Pop the first element of the list.
@@ -1033,7 +1135,7 @@ class coro_connection {
     /// (`std::nullopt`).
     /// @see https://redis.io/commands/lpop
     awaiter_t<std::string> lpop(std::string_view key) {
-        return impl_.command<std::string>(fmt::format("lpop {}", key));
+        return impl_.command_argv<std::string, "lpop">(key);
     }
 
     /// @brief Push an element to the beginning of the list.
@@ -1042,7 +1144,7 @@ class coro_connection {
     /// @return The length of the list after the operation.
     /// @see https://redis.io/commands/lpush
     inline awaiter_t<uint64_t> lpush(std::string_view key, std::string_view val) {
-        return impl_.command<uint64_t>(fmt::format("lpush {} {}", key, val));
+        return impl_.command_argv<uint64_t, "lpush">(key, val);
     }
 
     /// @brief Push multiple elements to the beginning of the list.
@@ -1059,10 +1161,18 @@ class coro_connection {
     /// @see https://redis.io/commands/lpush
     template <typename... Args>
     inline awaiter_t<uint64_t> lpush(std::string_view key, Args&&... keys) {
-        std::string cmd("lpush ");
-        cmd.append(key);
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "lpush">(key, keys...);
+    }
+
+    /// @brief Push every element of the given range to the head of the list.
+    /// @param key Key.
+    /// @param elements Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/lpush
+    template <RedisKeyRange R>
+    inline awaiter_t<uint64_t> lpush(std::string_view key, R&& elements) {
+        impl::command_args args("lpush", key);
+        args.append_range(elements);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Push an element to the beginning of the list, only if the list
@@ -1074,7 +1184,7 @@ class coro_connection {
     // TODO: add a multiple elements overload.
     inline awaiter_t<uint64_t> lpushx(std::string_view key,
                                       std::string_view val) {
-        return impl_.command<uint64_t>(fmt::format("lpushx {} {}", key, val));
+        return impl_.command_argv<uint64_t, "lpushx">(key, val);
     }
 
     /// @brief Get elements in the given range of the given list.
@@ -1092,11 +1202,11 @@ class coro_connection {
     /// @param output Output iterator to the destination where the results are
     /// saved.
     /// @see https://redis.io/commands/lrange
-    inline awaiter_t<std::vector<std::string>> lrange(std::string_view key,
+    template <typename T = std::vector<std::string>>
+    inline awaiter_t<T> lrange(std::string_view key,
                                             uint64_t start,
     uint64_t stop) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("lrange {} {} {}", key, start, stop));
+        return impl_.command_argv<T, "lrange">(key, start, stop);
     }
     /// @brief Remove the first `count` occurrences of elements equal to `val`.
     /// @param key Key where the list is stored.
@@ -1108,8 +1218,7 @@ class coro_connection {
     /// @see https://redis.io/commands/lrem
     inline awaiter_t<uint64_t> lrem(std::string_view key, uint64_t count,
                                     std::string_view val) {
-        return impl_.command<uint64_t>(
-                   fmt::format("lrem {} {} {}", key, count, val));
+        return impl_.command_argv<uint64_t, "lrem">(key, count, val);
     }
 
     /// @brief Set the element at the given index to the specified value.
@@ -1119,8 +1228,7 @@ class coro_connection {
     /// @see https://redis.io/commands/lset
     inline awaiter_t<std::string> lset(std::string_view key, uint64_t index,
                                        std::string_view val) {
-        return impl_.command<std::string>(
-                   fmt::format("lset {} {} {}", key, index, val));
+        return impl_.command_argv<std::string, "lset">(key, index, val);
     }
 
     /// @brief Trim a list to keep only element in the given range.
@@ -1130,8 +1238,7 @@ class coro_connection {
     /// @see https://redis.io/commands/ltrim
     inline awaiter_t<std::string> ltrim(std::string_view key, uint64_t start,
                                         uint64_t stop) {
-        return impl_.command<std::string>(
-                   fmt::format("ltrim {} {} {}", key, start, stop));
+        return impl_.command_argv<std::string, "ltrim">(key, start, stop);
     }
 
     /// @brief Pop the last element of a list.
@@ -1141,7 +1248,7 @@ class coro_connection {
     /// `OptionalString{}` (`std::nullopt`).
     /// @see https://redis.io/commands/rpop
     inline awaiter_t<std::string> rpop(std::string_view key) {
-        return impl_.command<std::string>(fmt::format("rpop {}", key));
+        return impl_.command_argv<std::string, "rpop">(key);
     }
 
     /// @brief Pop last element of one list and push it to the left of another
@@ -1154,8 +1261,7 @@ class coro_connection {
     /// @see https://redis.io/commands/brpoplpush
     inline awaiter_t<std::string> rpoplpush(std::string_view source,
                                             std::string_view destination) {
-        return impl_.command<std::string>(
-                   fmt::format("rpoplpush {} {}", source, destination));
+        return impl_.command_argv<std::string, "rpoplpush">(source, destination);
     }
 
     /// @brief Push an element to the end of the list.
@@ -1166,10 +1272,18 @@ class coro_connection {
     template <typename... Args>
     inline awaiter_t<uint64_t> rpush(std::string_view key, std::string_view val,
                                      Args&&... vals) {
-        std::string cmd("rpush ");
-        cmd.append(val);
-        (cmd.append(" ").append(vals), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "rpush">(key, val, vals...);
+    }
+
+    /// @brief Push every element of the given range to the tail of the list.
+    /// @param key Key.
+    /// @param elements Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/rpush
+    template <RedisKeyRange R>
+    inline awaiter_t<uint64_t> rpush(std::string_view key, R&& elements) {
+        impl::command_args args("rpush", key);
+        args.append_range(elements);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Push an element to the end of the list, only if the list already
@@ -1180,7 +1294,7 @@ class coro_connection {
     /// @see https://redis.io/commands/rpushx
     inline awaiter_t<uint64_t> rpushx(std::string_view key,
                                       std::string_view val) {
-        return impl_.command<uint64_t>(fmt::format("rpushx {} {}", key, val));
+        return impl_.command_argv<uint64_t, "rpushx">(key, val);
     }
 
     // HASH commands.
@@ -1195,10 +1309,18 @@ class coro_connection {
     template <typename... Args>
     inline awaiter_t<uint64_t> hdel(std::string_view key, std::string_view field,
                                     Args&&... fields) {
-        std::string cmd("hdel");
-        cmd.append(" ").append(field);
-        (cmd.append(" ").append(fields), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "hdel">(key, field, fields...);
+    }
+
+    /// @brief Remove every field of the given range from the hash.
+    /// @param key Key.
+    /// @param fields Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/hdel
+    template <RedisKeyRange R>
+    inline awaiter_t<uint64_t> hdel(std::string_view key, R&& fields) {
+        impl::command_args args("hdel", key);
+        args.append_range(fields);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Check if the given field exists in hash.
@@ -1210,7 +1332,7 @@ class coro_connection {
     /// @see https://redis.io/commands/hexists
     inline awaiter_t<uint64_t> hexists(std::string_view key,
                                        std::string_view field) {
-        return impl_.command<uint64_t>(fmt::format("hexists {} {}", key, field));
+        return impl_.command_argv<uint64_t, "hexists">(key, field);
     }
 
     /// @brief Get the value of the given field.
@@ -1222,27 +1344,27 @@ class coro_connection {
     /// @see https://redis.io/commands/hget
     inline awaiter_t<std::string> hget(std::string_view key,
                                        std::string_view field) {
-        return impl_.command<std::string>(fmt::format("hget {} {}", key, field));
+        return impl_.command_argv<std::string, "hget">(key, field);
     }
 
     /// @brief Get all field-value pairs of the given hash.
     ///
     /// Example:
     /// @code{.cpp}
-    /// std::unordered_map<std::string, std::string> results;
-    /// // Save all field-value pairs of a Redis hash to an unordered_map<string,
-    /// string>. redis.hgetall("hash", std::inserter(results, results.begin()));
+    /// // flat field, value, field, value... list
+    /// auto flat = co_await redis.hgetall("hash");
+    /// // decoded straight into a map, see `impl::reply_traits`
+    /// auto map = co_await redis.hgetall<std::unordered_map<std::string, std::string>>("hash");
     /// @endcode
+    /// @tparam T Result container.
     /// @param key Key where the hash is stored.
-    /// @param output Output iterator to the destination where the result is
-    /// saved.
     /// @note It's always a bad idea to call `hgetall` on a large hash, since it
     /// will block Redis.
     /// @see `Redis::hscan`
     /// @see https://redis.io/commands/hgetall
-    inline awaiter_t<std::vector<std::string>> hgetall(std::string_view key) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("hgetall {}", key));
+    template <typename T = std::vector<std::string>>
+    inline awaiter_t<T> hgetall(std::string_view key) {
+        return impl_.command_argv<T, "hgetall">(key);
     }
 
     /// @brief Increment the integer stored at the given field.
@@ -1254,8 +1376,7 @@ class coro_connection {
     inline awaiter_t<uint64_t> hincrby(std::string_view key,
                                        std::string_view field,
                                        uint64_t increment) {
-        return impl_.command<uint64_t>(
-                   fmt::format("hincrby {} {} {}", key, field, increment));
+        return impl_.command_argv<uint64_t, "hincrby">(key, field, increment);
     }
 
     /// @brief Increment the floating point number stored at the given field.
@@ -1267,8 +1388,7 @@ class coro_connection {
     inline awaiter_t<double> hincrbyfloat(std::string_view key,
                                           std::string_view field,
                                           double increment) {
-        return impl_.command<double>(
-                   fmt::format("hincrbyfloat {} {} {}", key, field, increment));
+        return impl_.command_argv<double, "hincrbyfloat">(key, field, increment);
     }
 
     /// @brief Get all fields of the given hash.
@@ -1279,9 +1399,9 @@ class coro_connection {
     /// will block Redis.
     /// @see `Redis::hscan`
     /// @see https://redis.io/commands/hkeys
-    inline awaiter_t<std::vector<std::string>> hkeys(std::string_view key) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("hkeys {}", key));
+    template <typename T = std::vector<std::string>>
+    inline awaiter_t<T> hkeys(std::string_view key) {
+        return impl_.command_argv<T, "hkeys">(key);
     }
 
     /// @brief Get the number of fields of the given hash.
@@ -1289,7 +1409,7 @@ class coro_connection {
     /// @return Number of fields.
     /// @see https://redis.io/commands/hlen
     inline awaiter_t<uint64_t> hlen(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("hlen {}", key));
+        return impl_.command_argv<uint64_t, "hlen">(key);
     }
 
     /// @brief Get values of multiple fields.
@@ -1315,15 +1435,22 @@ class coro_connection {
     ///       since the given field might not exist (in this case, the value of
     ///       the corresponding field is `OptionalString{}` (`std::nullopt`)).
     /// @see https://redis.io/commands/hmget
-    template <typename... Args>
-    inline awaiter_t<std::vector<std::string>> hmget(std::string_view key,
+    template <typename T = std::vector<std::string>, typename... Args>
+    inline awaiter_t<T> hmget(std::string_view key,
                                             std::string_view field,
     Args&&... fields) {
-        std::string cmd("hmget ");
-        cmd.append(" ").append(key);
-        cmd.append(" ").append(field);
-        (cmd.append(" ").append(fields), ...);
-        return impl_.command<std::vector<std::string>>(std::move(cmd));
+        return impl_.command_argv<T, "hmget">(key, field, fields...);
+    }
+
+    /// @brief Get the values of every field of the given range.
+    /// @param key Key.
+    /// @param fields Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/hmget
+    template <typename T = std::vector<std::string>, RedisKeyRange R>
+    inline awaiter_t<T> hmget(std::string_view key, R&& fields) {
+        impl::command_args args("hmget", key);
+        args.append_range(fields);
+        return impl_.command<T>(std::move(args));
     }
 
     /// @brief Set multiple field-value pairs of the given hash.
@@ -1341,12 +1468,18 @@ class coro_connection {
     inline awaiter_t<std::string> hmset(std::string_view key,
                                         std::string_view field,
                                         std::string_view value, Args&&... args) {
-        std::string cmd("hmset ");
-        cmd.append(" ").append(key);
-        cmd.append(" ").append(field);
-        cmd.append(" ").append(value);
-        (cmd.append(" ").append(args), ...);
-        return impl_.command<std::string>(std::move(cmd));
+        return impl_.command_argv<std::string, "hmset">(key, field, value, args...);
+    }
+
+    /// @brief Set every field-value pair of the given range.
+    /// @param key Key.
+    /// @param kvs Sized range, e.g. `std::vector` or `std::span` of pairs.
+    /// @see https://redis.io/commands/hmset
+    template <RedisPairRange R>
+    inline awaiter_t<std::string> hmset(std::string_view key, R&& kvs) {
+        impl::command_args args("hmset", key);
+        args.append_range(kvs);
+        return impl_.command<std::string>(std::move(args));
     }
 
     /// @brief Scan fields of the given hash matching the given pattern.
@@ -1408,11 +1541,7 @@ class coro_connection {
     template <typename... Args>
     inline awaiter_t<uint64_t> hset(std::string_view key, std::string_view field,
                                     std::string_view val, Args&&... args) {
-        std::string cmd("hset ");
-        cmd.append(" ").append(field);
-        cmd.append(" ").append(val);
-        (cmd.append(" ").append(args), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "hset">(key, field, val, args...);
     }
 
     /// @brief Set multiple fields of the given hash.
@@ -1443,8 +1572,7 @@ class coro_connection {
     inline awaiter_t<uint64_t> hsetnx(std::string_view key,
                                       std::string_view field,
                                       std::string_view val) {
-        return impl_.command<uint64_t>(
-                   fmt::format("hsetnx {} {} {}", key, field, val));
+        return impl_.command_argv<uint64_t, "hsetnx">(key, field, val);
     }
 
     /// @brief Get the length of the string stored at the given field.
@@ -1454,7 +1582,7 @@ class coro_connection {
     /// @see https://redis.io/commands/hstrlen
     inline awaiter_t<uint64_t> hstrlen(std::string_view key,
                                        std::string_view field) {
-        return impl_.command<uint64_t>(fmt::format("hstrlen {} {}", key, field));
+        return impl_.command_argv<uint64_t, "hstrlen">(key, field);
     }
 
     /// @brief Get values of all fields stored at the given hash.
@@ -1465,9 +1593,9 @@ class coro_connection {
     /// might block Redis.
     /// @see `Redis::hscan`
     /// @see https://redis.io/commands/hvals
-    inline awaiter_t<std::vector<std::string>> hvals(std::string_view key) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("hvals {}", key));
+    template <typename T = std::vector<std::string>>
+    inline awaiter_t<T> hvals(std::string_view key) {
+        return impl_.command_argv<T, "hvals">(key);
     }
 
     // SET commands.
@@ -1482,11 +1610,18 @@ class coro_connection {
     template <typename... Args>
     inline awaiter_t<uint64_t> sadd(std::string_view key, std::string_view member,
                                     Args&&... members) {
-        std::string cmd("sadd");
-        cmd.append(" ").append(key);
-        cmd.append(" ").append(member);
-        (cmd.append(" ").append(members), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "sadd">(key, member, members...);
+    }
+
+    /// @brief Add every member of the given range to the set.
+    /// @param key Key.
+    /// @param members Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/sadd
+    template <RedisKeyRange R>
+    inline awaiter_t<uint64_t> sadd(std::string_view key, R&& members) {
+        impl::command_args args("sadd", key);
+        args.append_range(members);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Get the number of members in the set.
@@ -1494,7 +1629,7 @@ class coro_connection {
     /// @return Number of members.
     /// @see https://redis.io/commands/scard
     inline awaiter_t<uint64_t> scard(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("scard {}", key));
+        return impl_.command_argv<uint64_t, "scard">(key);
     }
 
     /// @brief Get the difference between the first set and all successive sets.
@@ -1505,13 +1640,10 @@ class coro_connection {
     /// @see https://redis.io/commands/sdiff
     // TODO: `void sdiff(const StringView &key, Input first, Input last, Output
     // output)` is better.
-    template <typename... Args>
-    inline awaiter_t<std::vector<std::string>> sdiff(std::string_view key,
+    template <typename T = std::vector<std::string>, typename... Args>
+    inline awaiter_t<T> sdiff(std::string_view key,
     Args&&... keys) {
-        std::string cmd("sdiff");
-        cmd.append(" ").append(key);
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<std::vector<std::string>>(std::move(cmd));
+        return impl_.command_argv<T, "sdiff">(key, keys...);
     }
 
     /// @brief Copy set stored at `key` to `destination`.
@@ -1522,11 +1654,7 @@ class coro_connection {
     template <typename... Args>
     inline awaiter_t<uint64_t> sdiffstore(std::string_view destination,
                                           std::string_view key, Args&&... keys) {
-        std::string cmd("sdiffstore");
-        cmd.append(" ").append(destination);
-        cmd.append(" ").append(key);
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "sdiffstore">(destination, key, keys...);
     }
 
     /// @brief Get the intersection between the first set and all successive sets.
@@ -1537,13 +1665,10 @@ class coro_connection {
     /// @see https://redis.io/commands/sinter
     // TODO: `void sinter(const StringView &key, Input first, Input last, Output
     // output)` is better.
-    template <typename... Args>
-    inline awaiter_t<std::vector<std::string>> sinter(std::string_view key,
+    template <typename T = std::vector<std::string>, typename... Args>
+    inline awaiter_t<T> sinter(std::string_view key,
     Args&&... keys) {
-        std::string cmd("sinter");
-        cmd.append(" ").append(key);
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<std::vector<std::string>>(std::move(cmd));
+        return impl_.command_argv<T, "sinter">(key, keys...);
     }
 
     /// @brief Copy set stored at `key` to `destination`.
@@ -1554,11 +1679,7 @@ class coro_connection {
     template <typename... Args>
     inline awaiter_t<uint64_t> sinterstore(std::string_view destination,
                                            std::string_view key, Args&&... keys) {
-        std::string cmd("sinterstore");
-        cmd.append(" ").append(destination);
-        cmd.append(" ").append(key);
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "sinterstore">(destination, key, keys...);
     }
 
     /// @brief Test if `member` exists in the set stored at key.
@@ -1571,7 +1692,7 @@ class coro_connection {
     /// @see https://redis.io/commands/sismember
     inline awaiter_t<uint64_t> sismember(std::string_view key,
                                          std::string_view member) {
-        return impl_.command<uint64_t>(fmt::format("sismember {} {}", key, member));
+        return impl_.command_argv<uint64_t, "sismember">(key, member);
     }
 
     /// @brief Get all members in the given set.
@@ -1586,9 +1707,9 @@ class coro_connection {
     /// @param key Key where the set is stored.
     /// @param output Iterator to the destination where the result is saved.
     /// @see https://redis.io/commands/smembers
-    inline awaiter_t<std::vector<std::string>> smembers(std::string_view key) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("smembers {}", key));
+    template <typename T = std::vector<std::string>>
+    inline awaiter_t<T> smembers(std::string_view key) {
+        return impl_.command_argv<T, "smembers">(key);
     }
 
     /// @brief Move `member` from one set to another.
@@ -1601,8 +1722,7 @@ class coro_connection {
     inline awaiter_t<uint64_t> smove(std::string_view source,
                                      std::string_view destination,
                                      std::string_view member) {
-        return impl_.command<uint64_t>(
-                   fmt::format("smove {} {} {}", source, destination, member));
+        return impl_.command_argv<uint64_t, "smove">(source, destination, member);
     }
 
     /// @brief Remove a random member from the set.
@@ -1612,10 +1732,10 @@ class coro_connection {
     /// (`std::nullopt`).
     /// @see `Redis::srandmember`
     /// @see https://redis.io/commands/spop
-    inline awaiter_t<std::vector<std::string>> spop(std::string_view key,
+    template <typename T = std::vector<std::string>>
+    inline awaiter_t<T> spop(std::string_view key,
     uint64_t count = 1) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("spop {} {}", key, count));
+        return impl_.command_argv<T, "spop">(key, count);
     }
 
     /// @brief Get a random member of the given set.
@@ -1627,7 +1747,7 @@ class coro_connection {
     /// @see `Redis::spop`
     /// @see https://redis.io/commands/srandmember
     inline awaiter_t<std::string> srandmember(std::string_view key) {
-        return impl_.command<std::string>(fmt::format("srandmember {}", key));
+        return impl_.command_argv<std::string, "srandmember">(key);
     }
 
     /// @brief Get multiple random members of the given set.
@@ -1638,10 +1758,10 @@ class coro_connection {
     /// @note This method won't remove members from the set.
     /// @see `Redis::spop`
     /// @see https://redis.io/commands/srandmember
-    inline awaiter_t<std::vector<std::string>> srandmember(std::string_view key,
+    template <typename T = std::vector<std::string>>
+    inline awaiter_t<T> srandmember(std::string_view key,
     uint64_t count) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("srandmember {} {}", key, count));
+        return impl_.command_argv<T, "srandmember">(key, count);
     }
 
     /// @brief Remove a member from set.
@@ -1654,11 +1774,18 @@ class coro_connection {
     template <typename... Args>
     inline awaiter_t<uint64_t> srem(std::string_view key, std::string_view member,
                                     Args&&... members) {
-        std::string cmd("srem");
-        cmd.append(" ").append(key);
-        cmd.append(" ").append(member);
-        (cmd.append(" ").append(members), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "srem">(key, member, members...);
+    }
+
+    /// @brief Remove every member of the given range from the set.
+    /// @param key Key.
+    /// @param members Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/srem
+    template <RedisKeyRange R>
+    inline awaiter_t<uint64_t> srem(std::string_view key, R&& members) {
+        impl::command_args args("srem", key);
+        args.append_range(members);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Scan members of the set matching the given pattern.
@@ -1704,10 +1831,7 @@ class coro_connection {
     // output)` is better.
     template <typename... Args>
     inline awaiter_t<uint64_t> sunion(std::string_view key, Args&&... keys) {
-        std::string cmd("sunion");
-        cmd.append(" ").append(key);
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "sunion">(key, keys...);
     }
 
     /// @brief Copy set stored at `key` to `destination`.
@@ -1718,11 +1842,7 @@ class coro_connection {
     template <typename... Args>
     inline awaiter_t<uint64_t> sunionstore(std::string_view destination,
                                            std::string_view key, Args&&... keys) {
-        std::string cmd("sunionstore");
-        cmd.append(" ").append(destination);
-        cmd.append(" ").append(key);
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "sunionstore">(destination, key, keys...);
     }
 
     // SORTED SET commands.
@@ -1737,12 +1857,12 @@ class coro_connection {
     inline awaiter_t<std::vector<std::string>> bzpopmax(
     std::initializer_list<std::string_view> keys, uint64_t timeout = 0) {
         if (keys.size() == 0) return {};
-        std::string cmd("bzpopmax");
+        impl::command_args args("bzpopmax");
         for (const auto& key : keys) {
-            cmd.append(" ").append(key);
+            args.append(key);
         }
-        cmd.append(" ").append(std::to_string(timeout));
-        return impl_.command<std::vector<std::string>>(std::move(cmd));
+        args.append(timeout);
+        return impl_.command<std::vector<std::string>>(std::move(args));
     }
 
     /// @brief Pop the member with lowest score from sorted set in a blocking way.
@@ -1757,12 +1877,12 @@ class coro_connection {
     inline awaiter_t<std::vector<std::string>> bzpopmin(
     std::initializer_list<std::string_view> keys, uint64_t timeout = 0) {
         if (keys.size() == 0) return {};
-        std::string cmd("bzpopmin");
+        impl::command_args args("bzpopmin");
         for (const auto& key : keys) {
-            cmd.append(" ").append(key);
+            args.append(key);
         }
-        cmd.append(" ").append(std::to_string(timeout));
-        return impl_.command<std::vector<std::string>>(std::move(cmd));
+        args.append(timeout);
+        return impl_.command<std::vector<std::string>>(std::move(args));
     }
 
     /// @brief Add or update a member with score to sorted set.
@@ -1872,7 +1992,7 @@ class coro_connection {
     /// @return Number of members in the sorted set.
     /// @see https://redis.io/commands/zcard
     inline awaiter_t<uint64_t> zcard(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("zcard {}", key));
+        return impl_.command_argv<uint64_t, "zcard">(key);
     }
 
     /// @brief Get the number of members with score between a min-max score range.
@@ -1892,8 +2012,7 @@ class coro_connection {
     // TODO: add a string version of Interval: zcount("key", "2.3", "5").
     inline awaiter_t<uint64_t> zcount(std::string_view key, std::string_view min,
                                       std::string_view max) {
-        return impl_.command<uint64_t>(
-                   fmt::format("zcount {} {} {}", key, min, max));
+        return impl_.command_argv<uint64_t, "zcount">(key, min, max);
     }
 
     /// @brief Increment the score of given member.
@@ -1904,8 +2023,7 @@ class coro_connection {
     /// @see https://redis.io/commands/zincrby
     inline awaiter_t<double> zincrby(std::string_view key, double increment,
                                      std::string_view member) {
-        return impl_.command<double>(
-                   fmt::format("zincrby {} {} {}", key, increment, member));
+        return impl_.command_argv<double, "zincrby">(key, increment, member);
     }
     /*
             /// @brief Copy a sorted set to another one with the scores being
@@ -1921,8 +2039,7 @@ class coro_connection {
             /// @see https://redis.io/commands/zinterstore
             //inline awaiter_t<uint64_t> zinterstore(std::string_view destination,
        std::string_view key, double weight) {
-            //	return impl_.command<double>(fmt::format("zinterstore {} {} {}",
-       key, increment, member));
+            //	return impl_.command_argv<double, "zinterstore">(key, increment, member);
             //}
 
 
@@ -1990,8 +2107,7 @@ class coro_connection {
     inline awaiter_t<uint64_t> zlexcount(std::string_view key,
                                          std::string_view min,
                                          std::string_view max) {
-        return impl_.command<uint64_t>(
-                   fmt::format("zlexcount {} {} {}", key, min, max));
+        return impl_.command_argv<uint64_t, "zlexcount">(key, min, max);
     }
 
     /// @brief Pop the member with highest score from sorted set.
@@ -2003,8 +2119,7 @@ class coro_connection {
     /// @see https://redis.io/commands/zpopmax
     inline awaiter_t<std::vector<std::string>> zpopmax(std::string_view key,
     uint64_t count = 1) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("zpopmax {} {}", key, count));
+        return impl_.command_argv<std::vector<std::string>, "zpopmax">(key, count);
     }
 
     /// @brief Pop the member with lowest score from sorted set.
@@ -2015,8 +2130,7 @@ class coro_connection {
     /// @see `Redis::bzpopmin`
     /// @see https://redis.io/commands/zpopmin
     inline awaiter_t<std::vector<std::string>> zpopmin(std::string_view key) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("zpopmin {}", key));
+        return impl_.command_argv<std::vector<std::string>, "zpopmin">(key);
     }
 
     /// @brief Get a range of members by rank (ordered from lowest to highest).
@@ -2024,31 +2138,29 @@ class coro_connection {
     /// Example:
     /// @code{.cpp}
     /// // send *ZRANGE* command without the *WITHSCORES* option:
-    /// std::vector<std::string> result;
-    /// redis.zrange("zset", 0, -1, std::back_inserter(result));
+    /// auto members = co_await redis.zrange("zset", "0", "-1");
     /// // send command with *WITHSCORES* option:
-    /// std::unordered_map<std::string, double> with_score;
-    /// redis.zrange("zset", 0, -1, std::inserter(with_score, with_score.end()));
+    /// auto with_score = co_await redis.zrange<
+    ///     std::vector<std::pair<std::string, double>>>("zset", "0", "-1");
     /// @endcode
+    /// @tparam T Result container.
     /// @param key Key where the sorted set is stored.
-    /// @param start Start rank. Inclusive and can be negative.
-    /// @param stop Stop rank. Inclusive and can be negative.
-    /// @param output Output iterator to the destination where the result is
-    /// saved.
-    /// @note This method can also return the score of each member. If `output` is
-    /// an iterator
-    ///       to a container of `std::string`, we send *ZRANGE key start stop*
-    ///       command. If it's an iterator to a container of
-    ///       `std::pair<std::string, double>`, we send *ZRANGE key start stop
-    ///       WITHSCORES* command. See the *Example* part on how to use this
-    ///       method.
+    /// @param min Start rank. Inclusive and can be negative.
+    /// @param max Stop rank. Inclusive and can be negative.
+    /// @note If `T` is a container of `std::string`, we send *ZRANGE key start
+    ///       stop* command. If it's a container of pairs, e.g.
+    ///       `std::unordered_map<std::string, double>`, we send *ZRANGE key
+    ///       start stop WITHSCORES*.
     /// @see `Redis::zrevrange`
     /// @see https://redis.io/commands/zrange
-    inline awaiter_t<std::vector<std::string>> zrange(std::string_view key,
-                                            std::string_view min,
-    std::string_view max) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("zrange {} {} {}", key, min, max));
+    template <typename T = std::vector<std::string>>
+    inline awaiter_t<T> zrange(std::string_view key, std::string_view min,
+                               std::string_view max) {
+        impl::command_args args("zrange", key, min, max);
+        if constexpr (impl::reply_stride_v<T> == 2) {
+            args.append("WITHSCORES");
+        }
+        return impl_.command<T>(std::move(args));
     }
 
     /// @brief Get a range of members by lexicographical order (from lowest to
@@ -2077,11 +2189,11 @@ class coro_connection {
     /// @see `Redis::zrevrangebylex`
     /// @see https://redis.io/commands/zrangebylex
     ///
-    inline awaiter_t<std::vector<std::string>> zrangebylex(std::string_view key,
+    template <typename T = std::vector<std::string>>
+    inline awaiter_t<T> zrangebylex(std::string_view key,
                                             std::string_view min,
     std::string_view max) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("zrangebylex {} {} {}", key, min, max));
+        return impl_.command_argv<T, "zrangebylex">(key, min, max);
     }
 
     /// @brief Get a range of members by score (ordered from lowest to highest).
@@ -2116,10 +2228,14 @@ class coro_connection {
     /// parameter.
     /// @see `Redis::zrevrangebyscore`
     /// @see https://redis.io/commands/zrangebyscore
-    inline awaiter_t<std::vector<std::string>> zrangebyscore(
-    std::string_view key, std::string_view min, std::string_view max) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("zrangebyscore {} {} {}", key, min, max));
+    template <typename T = std::vector<std::string>>
+    inline awaiter_t<T> zrangebyscore(std::string_view key, std::string_view min,
+                                      std::string_view max) {
+        impl::command_args args("zrangebyscore", key, min, max);
+        if constexpr (impl::reply_stride_v<T> == 2) {
+            args.append("WITHSCORES");
+        }
+        return impl_.command<T>(std::move(args));
     }
 
     /// @brief Get the rank (from low to high) of the given member in the sorted
@@ -2132,7 +2248,7 @@ class coro_connection {
     /// @see https://redis.io/commands/zrank
     inline awaiter_t<uint64_t> zrank(std::string_view key,
                                      std::string_view member) {
-        return impl_.command<uint64_t>(fmt::format("zrank {} {}", key, member));
+        return impl_.command_argv<uint64_t, "zrank">(key, member);
     }
 
     /// @brief Remove the given member from sorted set.
@@ -2145,11 +2261,18 @@ class coro_connection {
     template <typename... Args>
     inline awaiter_t<uint64_t> zrem(std::string_view key, std::string_view member,
                                     Args&&... members) {
-        std::string cmd("zrem");
-        cmd.append(" ").append(key);
-        cmd.append(" ").append(member);
-        (cmd.append(" ").append(members), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "zrem">(key, member, members...);
+    }
+
+    /// @brief Remove every member of the given range from the sorted set.
+    /// @param key Key.
+    /// @param members Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/zrem
+    template <RedisKeyRange R>
+    inline awaiter_t<uint64_t> zrem(std::string_view key, R&& members) {
+        impl::command_args args("zrem", key);
+        args.append_range(members);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Remove members in the given range of lexicographical order.
@@ -2168,8 +2291,7 @@ class coro_connection {
     inline awaiter_t<uint64_t> zremrangebylex(std::string_view key,
             std::string_view min,
             std::string_view max) {
-        return impl_.command<uint64_t>(
-                   fmt::format("zremrangebylex {} {} {}", key, min, max));
+        return impl_.command_argv<uint64_t, "zremrangebylex">(key, min, max);
     }
 
     /// @brief Remove members in the given range ordered by rank.
@@ -2180,8 +2302,7 @@ class coro_connection {
     /// @see https://redis.io/commands/zremrangebyrank
     inline awaiter_t<uint64_t> zremrangebyrank(std::string_view key,
             uint64_t start, uint64_t stop) {
-        return impl_.command<uint64_t>(
-                   fmt::format("zremrangebyrank {} {} {}", key, start, stop));
+        return impl_.command_argv<uint64_t, "zremrangebyrank">(key, start, stop);
     }
 
     /// @brief Remove members in the given range ordered by score.
@@ -2194,8 +2315,7 @@ class coro_connection {
     inline awaiter_t<uint64_t> zremrangebyscore(std::string_view key,
             std::string_view min,
             std::string_view max) {
-        return impl_.command<uint64_t>(
-                   fmt::format("zremrangebyscore {} {} {}", key, min, max));
+        return impl_.command_argv<uint64_t, "zremrangebyscore">(key, min, max);
     }
 
     /// @brief Get a range of members by rank (ordered from highest to lowest).
@@ -2227,9 +2347,9 @@ class coro_connection {
     inline awaiter_t<std::string> zrevrange(std::string_view key, uint64_t start,
                                             uint64_t stop,
                                             bool withscores = false) {
-        return impl_.command<std::string>(
-                   fmt::format("zrevrange {} {} {} {}", key, start, stop,
-                               (withscores ? "WITHSCORES" : "")));
+        impl::command_args args("zrevrange", key, start, stop);
+        if (withscores) args.append("WITHSCORES");
+        return impl_.command<std::string>(std::move(args));
     }
 
     /// @brief Get a range of members by lexicographical order (from highest to
@@ -2260,8 +2380,7 @@ class coro_connection {
     inline awaiter_t<std::string> zrevrangebylex(std::string_view key,
             std::string_view min,
             std::string_view max) {
-        return impl_.command<std::string>(
-                   fmt::format("zrevrangebylex {} {} {}", key, min, max));
+        return impl_.command_argv<std::string, "zrevrangebylex">(key, min, max);
     }
 
     /// @brief Get a range of members by score (ordered from highest to lowest).
@@ -2300,8 +2419,7 @@ class coro_connection {
     inline awaiter_t<std::string> zrevrangebyscore(std::string_view key,
             std::string_view min,
             std::string_view max) {
-        return impl_.command<std::string>(
-                   fmt::format("zrevrangebyscore {} {} {}", key, min, max));
+        return impl_.command_argv<std::string, "zrevrangebyscore">(key, min, max);
     }
 
     /// @brief Get the rank (from high to low) of the given member in the sorted
@@ -2314,7 +2432,7 @@ class coro_connection {
     /// @see https://redis.io/commands/zrevrank
     inline awaiter_t<uint64_t> zrevrank(std::string_view key,
                                         std::string_view member) {
-        return impl_.command<uint64_t>(fmt::format("zrevrank {} {}", key, member));
+        return impl_.command_argv<uint64_t, "zrevrank">(key, member);
     }
 
     /// @brief Scan all members of the given sorted set.
@@ -2351,7 +2469,7 @@ class coro_connection {
     /// @see https://redis.io/commands/zscore
     inline awaiter_t<double> zscore(std::string_view key,
                                     std::string_view member) {
-        return impl_.command<double>(fmt::format("zscore {} {}", key, member));
+        return impl_.command_argv<double, "zscore">(key, member);
     }
 
     /// @brief Copy a sorted set to another one with the scores being multiplied
@@ -2440,19 +2558,29 @@ class coro_connection {
     /// @see https://redis.io/commands/pfadd
     template <typename... Args>
     inline awaiter_t<uint64_t> pfadd(std::string_view key, Args&&... elements) {
-        std::string cmd("pfadd");
-        cmd.append(" ").append(key);
-        (cmd.append(" ").append(elements), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "pfadd">(key, elements...);
+    }
+
+    /// @brief Add every element of the given range to the HyperLogLog.
+    /// @param key Key.
+    /// @param elements Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/pfadd
+    template <RedisKeyRange R>
+    inline awaiter_t<uint64_t> pfadd(std::string_view key, R&& elements) {
+        impl::command_args args("pfadd", key);
+        args.append_range(elements);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
   private:
     coro_connection() = default;
-    inline awaiter_t<scan_ret_t> send_scan_cmd(std::string_view cmd) {
-        return impl_.send_scan_cmd(cmd);
+    inline awaiter_t<scan_ret_t> send_scan_cmd(impl::command_args args) {
+        return impl_.send_scan_cmd(std::move(args));
     }
 
   private:
+    friend class impl::bulk_loader_impl;
+    friend class impl::client_impl;
     impl::coro_connection_impl impl_;
 
 };  // class connectin
@@ -0,0 +1,243 @@
+//
+// Copyright (c) 2020 Gu.Qiwei(gqwmail@qq.com)
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+//
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <coro_redis/coro_connection.hpp>
+
+namespace coro_redis {
+
+///
+/// @brief Flow control of `bulk_loader`.
+///
+struct bulk_options {
+  size_t max_inflight = 1024;       // commands waiting for their reply
+  size_t max_bytes = 4 * 1024 * 1024;  // encoded bytes waiting for their reply
+  uint64_t progress_every = 10000;  // completions between progress reports
+};
+
+///
+/// @brief Counters of `bulk_loader`.
+///
+struct bulk_stats {
+  uint64_t sent = 0;       // commands written
+  uint64_t done = 0;       // replies received, failed ones included
+  uint64_t failed = 0;     // error replies, lost or unsent commands
+  uint64_t bytes = 0;      // encoded bytes written
+};
+
+namespace impl {
+
+///
+/// Lives on the heap: the reply callbacks point into its slot table, so when
+/// the owner goes away with commands in flight it stays until they drain.
+///
+class bulk_loader_impl {
+ public:
+  using error_handler_t = std::function<void(uint64_t tag, std::string_view err)>;
+  using progress_handler_t = std::function<void(const bulk_stats&)>;
+
+  bulk_loader_impl(std::vector<std::shared_ptr<coro_connection>> conns,
+                   bulk_options opt)
+      : conns_(std::move(conns)), opt_(opt) {
+    if (opt_.max_inflight == 0) opt_.max_inflight = 1;
+    inflight_.resize(conns_.size());
+    slots_.resize(opt_.max_inflight);
+    free_slots_.reserve(opt_.max_inflight);
+    for (size_t i = slots_.size(); i > 0; --i) free_slots_.push_back(i - 1);
+  }
+
+  bulk_loader_impl(const bulk_loader_impl&) = delete;
+  bulk_loader_impl& operator=(const bulk_loader_impl&) = delete;
+
+  /// Called by the owner instead of delete. Replies still in flight are
+  /// dropped, the last one frees the loader.
+  void release() {
+    if (total_inflight_ == 0) {
+      delete this;
+      return;
+    }
+    LOG_WARN("bulk loader released with {} commands in flight, their replies are dropped",
+             total_inflight_);
+    released_ = true;
+    waiter_ = nullptr;
+    error_handler_ = nullptr;
+    progress_handler_ = nullptr;
+  }
+
+  void set_error_handler(error_handler_t handler) {
+    error_handler_ = std::move(handler);
+  }
+
+  void set_progress_handler(progress_handler_t handler) {
+    progress_handler_ = std::move(handler);
+  }
+
+  const bulk_stats& stats() const { return stats_; }
+
+  size_t inflight() const { return total_inflight_; }
+
+  /// Suspends until the window has room, then writes the command.
+  class add_awaiter {
+   public:
+    add_awaiter(bulk_loader_impl* self, command_args args, uint64_t tag)
+        : self_(self), args_(std::move(args)), tag_(tag) {}
+
+    bool await_ready() const noexcept { return self_->has_room(); }
+    void await_suspend(coro::coroutine_handle<> h) { self_->waiter_ = h; }
+    void await_resume() { self_->send(args_, tag_); }
+
+   private:
+    bulk_loader_impl* self_;
+    command_args args_;
+    uint64_t tag_;
+  };
+
+  /// Suspends until every written command got its reply.
+  class flush_awaiter {
+   public:
+    explicit flush_awaiter(bulk_loader_impl* self) : self_(self) {}
+
+    bool await_ready() const noexcept { return self_->total_inflight_ == 0; }
+    void await_suspend(coro::coroutine_handle<> h) {
+      self_->flushing_ = true;
+      self_->waiter_ = h;
+    }
+    bulk_stats await_resume() {
+      self_->flushing_ = false;
+      self_->report_progress();
+      return self_->stats_;
+    }
+
+   private:
+    bulk_loader_impl* self_;
+  };
+
+  add_awaiter add(command_args args, uint64_t tag) {
+    return add_awaiter(this, std::move(args), tag);
+  }
+
+  flush_awaiter flush() { return flush_awaiter(this); }
+
+ private:
+  struct slot {
+    bulk_loader_impl* self = nullptr;
+    uint64_t tag = 0;
+    size_t bytes = 0;
+    size_t conn = 0;
+  };
+
+  // The byte budget is soft, the command exceeding it is still written.
+  bool has_room() const {
+    return total_inflight_ == 0 ||
+           (total_inflight_ < opt_.max_inflight && bytes_inflight_ < opt_.max_bytes);
+  }
+
+  size_t pick_conn() const {
+    size_t best = 0;
+    for (size_t i = 1; i < inflight_.size(); ++i) {
+      if (inflight_[i] < inflight_[best]) best = i;
+    }
+    return best;
+  }
+
+  void send(const command_args& args, uint64_t tag) {
+    if (conns_.empty()) {
+      fail(tag, "no connection");
+      return;
+    }
+    auto index = free_slots_.back();
+    auto& s = slots_[index];
+    s.self = this;
+    s.tag = tag;
+    s.conn = pick_conn();
+    auto& conn = conns_[s.conn]->impl_;
+    if (!conn.send(args, &on_reply, &s)) {
+      fail(tag, "send failed");
+      return;
+    }
+    free_slots_.pop_back();
+    s.bytes = conn.written();
+    ++inflight_[s.conn];
+    ++total_inflight_;
+    bytes_inflight_ += s.bytes;
+    ++stats_.sent;
+    stats_.bytes += s.bytes;
+  }
+
+  static void on_reply(redisAsyncContext* actx, void* r, void* privdata) {
+    coro_connection_impl::reply_done(actx);
+    auto* s = static_cast<slot*>(privdata);
+    auto* self = s->self;
+    auto* reply = (redisReply*)r;
+    --self->inflight_[s->conn];
+    --self->total_inflight_;
+    self->bytes_inflight_ -= s->bytes;
+    self->free_slots_.push_back(s - self->slots_.data());
+    if (self->released_) {
+      if (self->total_inflight_ == 0) delete self;
+      return;
+    }
+    if (reply == nullptr) {
+      self->fail(s->tag, actx->errstr ? actx->errstr : "connection lost");
+    } else if (reply->type == REDIS_REPLY_ERROR) {
+      self->fail(s->tag, std::string_view(reply->str, reply->len));
+    } else {
+      self->complete();
+    }
+    self->wake();
+  }
+
+  void fail(uint64_t tag, std::string_view err) {
+    ++stats_.failed;
+    if (error_handler_) error_handler_(tag, err);
+    complete();
+  }
+
+  void complete() {
+    ++stats_.done;
+    if (opt_.progress_every > 0 && stats_.done % opt_.progress_every == 0) {
+      report_progress();
+    }
+  }
+
+  void report_progress() {
+    if (progress_handler_) progress_handler_(stats_);
+  }
+
+  void wake() {
+    if (!waiter_) return;
+    if (flushing_ ? total_inflight_ != 0 : !has_room()) return;
+    auto h = waiter_;
+    waiter_ = nullptr;
+    h.resume();
+  }
+
+  std::vector<std::shared_ptr<coro_connection>> conns_;
+  bulk_options opt_;
+  std::vector<size_t> inflight_;     // per connection
+  std::vector<slot> slots_;          // callback data of in flight commands
+  std::vector<size_t> free_slots_;
+  size_t total_inflight_ = 0;
+  size_t bytes_inflight_ = 0;
+  bulk_stats stats_;
+  coro::coroutine_handle<> waiter_;  // the producer, blocked by the window
+  bool flushing_ = false;
+  bool released_ = false;            // the owner is gone, draining replies
+  error_handler_t error_handler_;
+  progress_handler_t progress_handler_;
+};
+
+}  // namespace impl
+}  // namespace coro_redis
@@ -0,0 +1,118 @@
+//
+// Copyright (c) 2020 Gu.Qiwei(gqwmail@qq.com)
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+//
+#pragma once
+
+#include <memory>
+
+namespace coro_redis {
+namespace impl {
+
+template <typename CORO_RET> class command_awaiter;
+
+///
+/// @brief Shared by a `cancel_source` and its tokens, keeps the awaits to
+///   abort in an intrusive list.
+///
+class cancel_state {
+ public:
+  struct node {
+    node* prev = nullptr;
+    node* next = nullptr;
+    void (*on_cancel)(node*) = nullptr;
+    bool linked = false;
+  };
+
+  bool cancelled() const { return cancelled_; }
+
+  void link(node* n) {
+    n->prev = nullptr;
+    n->next = head_;
+    if (head_ != nullptr) head_->prev = n;
+    head_ = n;
+    n->linked = true;
+  }
+
+  void unlink(node* n) {
+    if (!n->linked) return;
+    (n->prev ? n->prev->next : head_) = n->next;
+    if (n->next != nullptr) n->next->prev = n->prev;
+    n->prev = n->next = nullptr;
+    n->linked = false;
+  }
+
+  // A callback may link or unlink other nodes, take one at a time.
+  void cancel() {
+    if (cancelled_) return;
+    cancelled_ = true;
+    while (head_ != nullptr) {
+      auto* n = head_;
+      unlink(n);
+      n->on_cancel(n);
+    }
+  }
+
+ private:
+  node* head_ = nullptr;
+  bool cancelled_ = false;
+};
+
+}  // namespace impl
+
+///
+/// @brief Observes a `cancel_source`, passed to the awaits it may abort.
+///
+/// A default constructed token is never cancelled.
+///
+class cancel_token {
+ public:
+  cancel_token() = default;
+
+  bool cancelled() const { return state_ && state_->cancelled(); }
+  explicit operator bool() const { return state_ != nullptr; }
+
+ private:
+  friend class cancel_source;
+  template <typename> friend class impl::command_awaiter;
+
+  explicit cancel_token(std::shared_ptr<impl::cancel_state> state)
+      : state_(std::move(state)) {}
+
+  std::shared_ptr<impl::cancel_state> state_;
+};
+
+///
+/// @brief Aborts every await holding one of its tokens.
+///
+/// The aborted coroutines resume at once with `std::nullopt`, commands
+/// already written still get their reply, which is dropped; the connection
+/// is not affected. Awaits started after `cancel()` complete immediately.
+/// Not thread safe, cancel on the loop the awaiting coroutines run on.
+///
+/// Example:
+/// @code{.cpp}
+///   cancel_source stop;
+///   auto val = co_await conn->get("key").with_cancel(stop.token());
+///   // elsewhere on the same loop, e.g. when the request is abandoned
+///   stop.cancel();
+/// @endcode
+///
+class cancel_source {
+ public:
+  cancel_source() : state_(std::make_shared<impl::cancel_state>()) {}
+
+  cancel_token token() const { return cancel_token(state_); }
+
+  void cancel() { state_->cancel(); }
+
+  bool cancelled() const { return state_->cancelled(); }
+
+ private:
+  std::shared_ptr<impl::cancel_state> state_;
+};
+
+}  // namespace coro_redis
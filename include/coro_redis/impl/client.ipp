@@ -6,8 +6,12 @@
 // https://opensource.org/licenses/MIT
 //
 #pragma once
-#include <list>
+#include <any>
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <vector>
 #include <hiredis/async.h>
 
 #include <coro_redis/context.hpp>
@@ -15,6 +19,22 @@
 #include <coro_redis/sync_connection.hpp>
 
 namespace coro_redis {
+
+///
+/// @brief Options of the connection pool.
+///
+struct pool_options {
+  long acquire_timeout_ms = 0;  // 0 waits until a connection is recycled
+  size_t max_waiters = 0;       // per io_context, beyond it fetches fail at once
+  bool steal = true;            // take free connections of other io_contexts
+  bool thread_affine = true;    // callers on a pool loop only get its connections
+  bool multiplex = false;       // shared by the callers of their loop, not checked out
+  bool warm_up = false;         // connect everything at pool_init, see ready()
+  std::string user;             // ACL user of AUTH, empty for the default user
+  std::string password;         // AUTH is sent first on every connection if set
+  int db = 0;                   // SELECTed on every connection if not 0
+};
+
 namespace impl {
 struct timeval_t {
   long tv_sec;  /* seconds */
@@ -25,9 +45,11 @@ class client_impl {
  private:
   using awaiter_t = task_awaiter<std::shared_ptr<coro_connection>, const redisAsyncContext*>;
   using fetch_awaiter_t = task_awaiter<std::shared_ptr<coro_connection>>;
+  using ready_awaiter_t = task_awaiter<bool>;
  public:
   awaiter_t coro_connect(const io_context& ioc, std::string_view host_sv,
-                         uint16_t port, long timeout_seconds) {
+                         uint16_t port, long timeout_seconds,
+                         RedisProtocol protocol = RedisProtocol::RESP2) {
     return awaiter_t(
         [&ioc, host = std::string(host_sv), port, timeout_seconds](
             awaiter_t* awaiter, const coro::coroutine_handle<>&) {
@@ -66,21 +88,25 @@ class client_impl {
               });
           redisAsyncSetDisconnectCallback(
               actx, [](const struct redisAsyncContext* actx, int status) {
+                // a failed connect only reports to the connect callback, by
+                // now the awaiter is gone and `data` is the connection's
                 LOG_INFO("redis disconnect status: {}", status);
-                auto* awaiter = (awaiter_t*)actx->data;
-                awaiter->set_coro_return(nullptr);
               });
         },
-        [](awaiter_t* awaiter, const coro::coroutine_handle<>&)
+        [&ioc, protocol](awaiter_t* awaiter, const coro::coroutine_handle<>&)
             -> std::shared_ptr<coro_connection> {
           ASSERT_RETURN(awaiter->coro_return().has_value(), nullptr, "redis connect failed.");
-          return std::make_shared<coro_connection>((redisAsyncContext*)awaiter->coro_return().value());
+          auto conn = std::make_shared<coro_connection>((redisAsyncContext*)awaiter->coro_return().value(), protocol);
+          conn->impl_.set_context(&ioc);
+          return conn;
         });
   }
 
   std::shared_ptr<sync_connection> sync_connect(std::string_view host,
                                                 uint16_t port,
-                                                long timeout_seconds) {
+                                                long timeout_seconds,
+                                                RedisProtocol protocol =
+                                                    RedisProtocol::RESP2) {
     ASSERT_RETURN(!host.empty(), nullptr, "redis host not set");
     ASSERT_RETURN(port > 0, nullptr, "redis port not set");
 
@@ -96,78 +122,120 @@ class client_impl {
 
     auto* ctx = redisConnectWithOptions(&opt);
     ASSERT_RETURN(ctx != nullptr, nullptr, "redis connect failed.");
-    return std::make_shared<sync_connection>(ctx);
+    return std::make_shared<sync_connection>(ctx, protocol);
   }
 
 	void pool_init(std::vector<io_context*> pool_ios,
                  std::string_view host_sv,
                  uint16_t port,
-                 long timeout_seconds = 5) {
-    std::lock_guard<std::mutex> locker(pool_mutex_);
-    pool_ios_ = pool_ios;
+                 long timeout_seconds = 5,
+                 RedisProtocol protocol = RedisProtocol::RESP2,
+                 pool_options opt = {}) {
+    ASSERT_RETURN(shards_.empty(), void(0), "redis pool already initialized");
     host_ = host_sv;
     port_ = port;
     timeout_ = timeout_seconds;
+    protocol_ = protocol;
+    opt_ = opt;
+    for (auto* ioc : pool_ios) {
+      auto* shard = find_shard(ioc);
+      if (shard == nullptr) {
+        shard = shards_.emplace_back(std::make_unique<pool_shard>()).get();
+        shard->pool = this;
+        shard->ioc = ioc;
+        shard->index = shards_.size() - 1;
+      }
+      ++shard->unconnected;
+    }
+    for (auto& shard : shards_) shard->slots.reserve(shard->unconnected);
+    if (!opt_.warm_up) return;
+
+    {
+      std::lock_guard<std::mutex> locker(ready_mutex_);
+      for (auto& shard : shards_) warming_ += shard->unconnected;
+    }
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> locker(shard->mutex);
+      size_t n = shard->unconnected;
+      for (size_t i = 0; i < n; ++i) {
+        --shard->unconnected;
+        if (connect(*shard, nullptr)) continue;
+        ++shard->unconnected;
+        warm_done(false);
+      }
+    }
+  }
+
+  ready_awaiter_t ready() {
+    return ready_awaiter_t(
+        [this](ready_awaiter_t* awaiter, const coro::coroutine_handle<>&) {
+          std::unique_lock<std::mutex> locker(ready_mutex_);
+          if (warming_ > 0) {
+            ready_waiters_.push_back(awaiter);
+            return;
+          }
+          locker.unlock();
+          awaiter->resume();
+        },
+        [this](ready_awaiter_t*, const coro::coroutine_handle<>&) {
+          std::lock_guard<std::mutex> locker(ready_mutex_);
+          return warm_failed_ == 0;
+        });
   }
 
-  fetch_awaiter_t fetch_coro_conn() {
+  fetch_awaiter_t fetch_coro_conn(const io_context* ioc = nullptr,
+                                  long timeout_ms = -1) {
     return fetch_awaiter_t(
-        [this](fetch_awaiter_t* awaiter, const coro::coroutine_handle<>&) {
-          std::lock_guard<std::mutex> locker(pool_mutex_);
-          if (!this->free_pool_.empty()) {
-            // find available connection
+        [this, ioc, timeout_ms](fetch_awaiter_t* awaiter,
+                                const coro::coroutine_handle<>&) {
+          if (shards_.empty()) {
+            LOG_ERROR("redis pool not initialized");
             awaiter->resume();
             return;
           }
-          // no available connection, try to create one
-          if (!this->pool_ios_.empty())
-          {
-            auto* ioc = pool_ios_.back();
-            pool_ios_.pop_back();
-            timeval_t timeout = {timeout_, 0};  // 1.5 seconds
-            redisOptions opt{};
-            std::string sh(host_.data(), host_.size());
-            opt.endpoint.tcp.ip = sh.c_str();
-            opt.endpoint.tcp.port = port_;
-            opt.connect_timeout = (const timeval*)&timeout;
-            opt.command_timeout = (const timeval*)&timeout;
-            redisAsyncContext* actx = redisAsyncConnectWithOptions(&opt);
-            ASSERT_RETURN(actx != nullptr, void(0),
-                          "connect redis failed, {}:{}", host_, port_);
-            ASSERT_RETURN(actx->err == 0, void(0),
-                          "connect redis failed, {}:{}", actx->err,
-                          actx->errstr);
-            ASSERT_RETURN(ioc->attach(actx) == REDIS_OK, void(0),
-                          "redis event attach failed.");
-            awaiter->set_coro_return(this);
-            actx->data = awaiter;
-            redisAsyncSetConnectCallback(
-                actx, [](const struct redisAsyncContext* actx, int status) {
-                  auto* awaiter = (fetch_awaiter_t*)actx->data;
-                  client_impl* clt = std::any_cast<client_impl*>(
-                      awaiter->coro_return().value());
-                  clt->add_new_conn((redisAsyncContext*)actx);
-                  awaiter->resume();
-                });
-            redisAsyncSetDisconnectCallback(
-                actx, [](const struct redisAsyncContext* actx, int status) {
-                  LOG_INFO("redis disconnect status: {}", status);
-                  auto* awaiter = (fetch_awaiter_t*)actx->data;
-                  awaiter->resume();
-                });
+          auto* caller = ioc ? ioc : io_context::current();
+          auto* own = caller ? find_shard(caller) : nullptr;
+          if (opt_.multiplex && own == nullptr) {
+            // a shared connection is only safe on the loop driving it
+            LOG_ERROR("multiplexed redis pool fetched off its io_contexts");
+            awaiter->resume();
             return;
           }
-          // if no available context, create failed, wait other connection to free
+          auto& home = own ? *own : next_shard();
           {
-            fetch_awaiters_.push_back(awaiter);
+            std::unique_lock<std::mutex> locker(home.mutex);
+            if (serve(home, awaiter, locker)) return;
+          }
+          // steal from the other shards, without waiting for their locks;
+          // their connections are driven by another thread
+          bool steal = opt_.steal && !opt_.multiplex &&
+                       !(opt_.thread_affine && own != nullptr);
+          for (size_t i = 1; steal && i < shards_.size(); ++i) {
+            auto& shard = *shards_[(home.index + i) % shards_.size()];
+            std::unique_lock<std::mutex> locker(shard.mutex, std::try_to_lock);
+            if (locker.owns_lock() && serve(shard, awaiter, locker)) return;
+          }
+          // if no available context, wait other connection to free
+          std::unique_lock<std::mutex> locker(home.mutex);
+          if (serve(home, awaiter, locker)) return;
+          if (opt_.max_waiters > 0 && home.waiter_count >= opt_.max_waiters) {
+            locker.unlock();
+            LOG_WARN("redis pool exhausted, {} coroutines waiting", opt_.max_waiters);
+            awaiter->resume();
             return;
           }
+          auto* w = new pool_waiter{&home, awaiter};
+          home.push_waiter(w);
+          long ms = timeout_ms < 0 ? opt_.acquire_timeout_ms : timeout_ms;
+          if (ms > 0 && caller != nullptr) {
+            w->timer = caller->add_timer(ms, &on_wait_timeout, w);
+          }
         },
         [](fetch_awaiter_t* awaiter, const coro::coroutine_handle<>&)
             -> std::shared_ptr<coro_connection> {
-          client_impl* clt =
-              std::any_cast<client_impl*>(awaiter->coro_return().value());
-          return clt->fetch_from_free_pool();
+          auto& ret = awaiter->coro_return();
+          if (!ret.has_value()) return nullptr;
+          return std::any_cast<std::shared_ptr<coro_connection>>(*ret);
         });
   }
 
@@ -201,42 +269,394 @@ class client_impl {
   //  return nullptr;
   //}
 
-  std::shared_ptr<coro_connection> fetch_from_free_pool() {
-    std::lock_guard<std::mutex> locker(pool_mutex_);
-    if (free_pool_.empty()) return nullptr;
-    auto conn = free_pool_.front();
-    free_pool_.pop_front();
-    inuse_pool_.push_back(conn);
-    return conn;
+  /// @brief Coroutines waiting for a connection.
+  size_t waiting() {
+    size_t n = 0;
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> locker(shard->mutex);
+      n += shard->waiter_count;
+    }
+    return n;
   }
 
-  std::shared_ptr<coro_connection> add_new_conn(redisAsyncContext* actx) {
-    std::lock_guard<std::mutex> locker(pool_mutex_);
-    std::shared_ptr<coro_connection> conn(
-        new coro_connection(actx), [this](auto p) { recycle_conn(p); });
-    inuse_pool_.push_back(conn);
-    return conn;
+ private:
+  struct pool_shard;
+
+  struct pool_waiter {
+    pool_shard* shard;
+    fetch_awaiter_t* awaiter;  // nullptr once handed a connection
+    void* timer = nullptr;     // deletes the waiter when it fires
+    pool_waiter* prev = nullptr;
+    pool_waiter* next = nullptr;
+  };
+
+  struct pool_slot {
+    std::unique_ptr<coro_connection> conn;
+    size_t next_free = npos;
+    bool in_use = false;
+  };
+
+  ///
+  /// Recycles the control blocks of lent shared_ptrs, so lending a
+  /// connection does not allocate once the pool is warm.
+  ///
+  class lease_pool {
+   public:
+    ~lease_pool() {
+      while (head_ != nullptr) {
+        auto* b = head_;
+        head_ = b->next;
+        ::operator delete(b);
+      }
+    }
+
+    void* take(size_t n) {
+      if (n > kBlockSize) return ::operator new(n);
+      std::lock_guard<std::mutex> locker(mutex_);
+      if (head_ == nullptr) return ::operator new(kBlockSize);
+      auto* b = head_;
+      head_ = b->next;
+      return b;
+    }
+
+    void give(void* p, size_t n) {
+      if (n > kBlockSize) return ::operator delete(p);
+      std::lock_guard<std::mutex> locker(mutex_);
+      head_ = new (p) block{head_};
+    }
+
+   private:
+    struct block {
+      block* next;
+    };
+    static constexpr size_t kBlockSize = 64;
+
+    std::mutex mutex_;
+    block* head_ = nullptr;
+  };
+
+  template <typename T>
+  struct lease_allocator {
+    using value_type = T;
+
+    explicit lease_allocator(lease_pool* p) : pool(p) {}
+    template <typename U>
+    lease_allocator(const lease_allocator<U>& other) : pool(other.pool) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(pool->take(n * sizeof(T))); }
+    void deallocate(T* p, size_t n) { pool->give(p, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const lease_allocator<U>& other) const {
+      return pool == other.pool;
+    }
+
+    lease_pool* pool;
+  };
+
+  static constexpr size_t npos = size_t(-1);
+
+  ///
+  /// Connections of one io_context with their own lock, fetches and
+  /// releases on different loops do not contend.
+  ///
+  struct pool_shard {
+    // Waiters form an intrusive list, oldest first; mutex is held.
+    void push_waiter(pool_waiter* w) {
+      w->prev = wait_tail;
+      if (wait_tail != nullptr) {
+        wait_tail->next = w;
+      } else {
+        wait_head = w;
+      }
+      wait_tail = w;
+      ++waiter_count;
+    }
+
+    void erase_waiter(pool_waiter* w) {
+      (w->prev ? w->prev->next : wait_head) = w->next;
+      (w->next ? w->next->prev : wait_tail) = w->prev;
+      w->prev = w->next = nullptr;
+      --waiter_count;
+    }
+
+    // Dequeue every waiter, they are resumed after the lock is released.
+    std::vector<fetch_awaiter_t*> take_waiters() {
+      std::vector<fetch_awaiter_t*> awaiters;
+      awaiters.reserve(waiter_count);
+      while (wait_head != nullptr) {
+        auto* w = wait_head;
+        erase_waiter(w);
+        awaiters.push_back(w->awaiter);
+        w->awaiter = nullptr;
+        if (w->timer == nullptr) delete w;
+      }
+      return awaiters;
+    }
+
+    std::mutex mutex;
+    client_impl* pool = nullptr;
+    io_context* ioc = nullptr;
+    size_t index = 0;
+    size_t unconnected = 0;         // connections not created yet
+    std::vector<pool_slot> slots;   // owns the connections
+    size_t free_head = npos;        // free slots, linked by next_free
+    lease_pool leases;
+    pool_waiter* wait_head = nullptr;
+    pool_waiter* wait_tail = nullptr;
+    size_t waiter_count = 0;
+  };
+
+  struct pending_conn {
+    pool_shard* shard;
+    fetch_awaiter_t* awaiter;  // nullptr for warm-up
+  };
+
+  struct warm_conn {
+    client_impl* pool;
+    std::shared_ptr<coro_connection> conn;
+  };
+
+  pool_shard* find_shard(const io_context* ioc) {
+    for (auto& shard : shards_) {
+      if (shard->ioc == ioc) return shard.get();
+    }
+    return nullptr;
   }
 
-  void recycle_conn(coro_connection* p) {
-    std::lock_guard<std::mutex> locker(pool_mutex_);
-    auto iter = std::find_if(inuse_pool_.begin(), inuse_pool_.end(),
-                             [p](auto pp) { return pp.get() == p; });
-    if (iter == inuse_pool_.end()) return;
-    free_pool_.push_back(*iter);
+  // Home of callers which do not run on a pool loop.
+  pool_shard& next_shard() {
+    return *shards_[next_shard_.fetch_add(1, std::memory_order_relaxed) %
+                    shards_.size()];
+  }
+
+  // Take a free connection or start connecting a new one, locker holds
+  // shard.mutex. Returns false if the shard has neither.
+  bool serve(pool_shard& shard, fetch_awaiter_t* awaiter,
+             std::unique_lock<std::mutex>& locker) {
+    if (opt_.multiplex) return serve_shared(shard, awaiter, locker);
+    if (shard.free_head != npos) {
+      // find available connection
+      auto conn = take_free_conn(shard);
+      locker.unlock();
+      awaiter->set_coro_return(std::move(conn));
+      awaiter->resume();
+      return true;
+    }
+    if (shard.unconnected == 0) return false;
+    // no available connection, try to create one
+    --shard.unconnected;
+    if (!connect(shard, awaiter)) {
+      ++shard.unconnected;
+      locker.unlock();
+      awaiter->resume();
+    }
+    return true;
+  }
+
+  // Multiplexed mode: callers share the least busy connection, their
+  // commands are pipelined on it. The caller runs on the shard's loop, the
+  // only thread touching its connections. Connects only while it has none.
+  bool serve_shared(pool_shard& shard, fetch_awaiter_t* awaiter,
+                    std::unique_lock<std::mutex>& locker) {
+    coro_connection* best = nullptr;
+    for (auto& slot : shard.slots) {
+      if (best == nullptr || slot.conn->pending() < best->pending()) {
+        best = slot.conn.get();
+      }
+    }
+    if (best == nullptr && shard.unconnected > 0) {
+      --shard.unconnected;
+      if (!connect(shard, awaiter)) {
+        ++shard.unconnected;
+        locker.unlock();
+        awaiter->resume();
+      }
+      return true;
+    }
+    if (best == nullptr) return false;  // wait for the first connection
+    auto conn = share(best);
+    locker.unlock();
+    awaiter->set_coro_return(std::move(conn));
+    awaiter->resume();
+    return true;
+  }
+
+  // Shared connections are owned by the pool and never recycled.
+  static std::shared_ptr<coro_connection> share(coro_connection* conn) {
+    return std::shared_ptr<coro_connection>(std::shared_ptr<coro_connection>(),
+                                            conn);
+  }
+
+  // Start connecting on the shard's loop, the awaiter is resumed when done,
+  // without awaiter the connection is warmed up for the pool.
+  bool connect(pool_shard& shard, fetch_awaiter_t* awaiter) {
+    timeval_t timeout = {timeout_, 0};  // 1.5 seconds
+    redisOptions opt{};
+    std::string sh(host_.data(), host_.size());
+    opt.endpoint.tcp.ip = sh.c_str();
+    opt.endpoint.tcp.port = port_;
+    opt.connect_timeout = (const timeval*)&timeout;
+    opt.command_timeout = (const timeval*)&timeout;
+    redisAsyncContext* actx = redisAsyncConnectWithOptions(&opt);
+    ASSERT_RETURN(actx != nullptr, false, "connect redis failed, {}:{}", host_,
+                  port_);
+    ASSERT_RETURN(actx->err == 0, false, "connect redis failed, {}:{}",
+                  actx->err, actx->errstr);
+    ASSERT_RETURN(shard.ioc->attach(actx) == REDIS_OK, false,
+                  "redis event attach failed.");
+    actx->data = new pending_conn{&shard, awaiter};
+    redisAsyncSetConnectCallback(
+        actx, [](const struct redisAsyncContext* actx, int status) {
+          auto* pending = (pending_conn*)actx->data;
+          ((redisAsyncContext*)actx)->data = nullptr;
+          auto& shard = *pending->shard;
+          auto* awaiter = pending->awaiter;
+          delete pending;
+          std::vector<fetch_awaiter_t*> waiters;
+          if (status == REDIS_OK) {
+            auto conn = shard.pool->add_new_conn(
+                shard, (redisAsyncContext*)actx, waiters);
+            if (awaiter != nullptr) {
+              awaiter->set_coro_return(std::move(conn));
+            } else {
+              shard.pool->confirm(std::move(conn));
+            }
+          } else {
+            LOG_ERROR("redis connect error, {}({})", actx->errstr, actx->err);
+            std::lock_guard<std::mutex> locker(shard.mutex);
+            ++shard.unconnected;  // retry on next fetch
+            // nothing left which could serve the waiters
+            if (shard.slots.empty()) waiters = shard.take_waiters();
+            if (awaiter == nullptr) shard.pool->warm_done(false);
+          }
+          if (awaiter != nullptr) awaiter->resume();
+          for (auto* w : waiters) w->resume();
+        });
+    redisAsyncSetDisconnectCallback(
+        actx, [](const struct redisAsyncContext* actx, int status) {
+          LOG_INFO("redis disconnect status: {}", status);
+        });
+    return true;
+  }
+
+  // A warmed up connection is ready once PING answers behind AUTH, SELECT
+  // and HELLO, then it is released to the pool.
+  void confirm(std::shared_ptr<coro_connection> conn) {
+    auto& impl = conn->impl_;
+    auto* warm = new warm_conn{this, std::move(conn)};
+    auto sent = impl.send(
+        command_args("ping"),
+        [](redisAsyncContext* actx, void* reply, void* privdata) {
+          coro_connection_impl::reply_done(actx);
+          auto* r = (redisReply*)reply;
+          auto* warm = (warm_conn*)privdata;
+          auto* pool = warm->pool;
+          delete warm;
+          pool->warm_done(r != nullptr && r->type != REDIS_REPLY_ERROR);
+        },
+        warm);
+    if (!sent) {
+      delete warm;
+      warm_done(false);
+    }
+  }
+
+  void warm_done(bool ok) {
+    std::vector<ready_awaiter_t*> awaiters;
+    {
+      std::lock_guard<std::mutex> locker(ready_mutex_);
+      if (!ok) ++warm_failed_;
+      if (--warming_ > 0) return;
+      awaiters.swap(ready_waiters_);
+    }
+    for (auto* awaiter : awaiters) awaiter->resume();
+  }
+
+  // Called with shard.mutex held.
+  std::shared_ptr<coro_connection> take_free_conn(pool_shard& shard) {
+    auto index = shard.free_head;
+    auto& slot = shard.slots[index];
+    shard.free_head = slot.next_free;
+    slot.in_use = true;
+    return lend(shard, index);
+  }
+
+  // The connection comes back to the pool when the last reference drops.
+  std::shared_ptr<coro_connection> lend(pool_shard& shard, size_t index) {
+    auto* sp = &shard;
+    return std::shared_ptr<coro_connection>(
+        shard.slots[index].conn.get(),
+        [sp, index](coro_connection*) { sp->pool->recycle_conn(*sp, index); },
+        lease_allocator<coro_connection>(&shard.leases));
+  }
+
+  std::shared_ptr<coro_connection> add_new_conn(
+      pool_shard& shard, redisAsyncContext* actx,
+      std::vector<fetch_awaiter_t*>& waiters) {
+    std::lock_guard<std::mutex> locker(shard.mutex);
+    auto& slot = shard.slots.emplace_back();
+    slot.conn = std::make_unique<coro_connection>(actx, protocol_, opt_.user,
+                                                  opt_.password, opt_.db);
+    slot.conn->impl_.set_context(shard.ioc);
+    if (opt_.multiplex) {
+      // a shared connection serves everyone waiting for the first one
+      waiters = shard.take_waiters();
+      for (auto* w : waiters) w->set_coro_return(share(slot.conn.get()));
+      return share(slot.conn.get());
+    }
+    slot.in_use = true;
+    return lend(shard, shard.slots.size() - 1);
+  }
+
+  void recycle_conn(pool_shard& shard, size_t index) {
+    std::unique_lock<std::mutex> locker(shard.mutex);
+    auto& slot = shard.slots[index];
+    if (!slot.in_use) return;
+    if (shard.wait_head == nullptr) {
+      slot.in_use = false;
+      slot.next_free = shard.free_head;
+      shard.free_head = index;
+      return;
+    }
+    // hand the connection over to the oldest waiter, it stays in use
+    auto* w = shard.wait_head;
+    shard.erase_waiter(w);
+    auto* awaiter = w->awaiter;
+    w->awaiter = nullptr;
+    if (w->timer == nullptr) delete w;
+    auto conn = lend(shard, index);
+    locker.unlock();
+    awaiter->set_coro_return(std::move(conn));
+    awaiter->resume();
+  }
+
+  static void on_wait_timeout(void* arg) {
+    auto* w = (pool_waiter*)arg;
+    std::unique_lock<std::mutex> locker(w->shard->mutex);
+    auto* awaiter = w->awaiter;
+    if (awaiter != nullptr) w->shard->erase_waiter(w);
+    delete w;
+    locker.unlock();
+    if (awaiter != nullptr) {
+      LOG_WARN("fetch redis connection timeout");
+      awaiter->resume();
+    }
   }
 
- private:
-  std::mutex pool_mutex_;
   std::string host_;
   uint16_t port_ = 0;
   long timeout_ = 0;
-  std::vector<io_context*> pool_ios_;
+  RedisProtocol protocol_ = RedisProtocol::RESP2;
+  pool_options opt_;
 
-  std::list<std::shared_ptr<coro_connection>> free_pool_;
-  std::list<std::shared_ptr<coro_connection>> inuse_pool_;
+  std::vector<std::unique_ptr<pool_shard>> shards_;  // one per io_context
+  std::atomic<size_t> next_shard_{0};
 
-  std::list<fetch_awaiter_t*> fetch_awaiters_;
+  std::mutex ready_mutex_;  // warm-up progress
+  size_t warming_ = 0;
+  size_t warm_failed_ = 0;
+  std::vector<ready_awaiter_t*> ready_waiters_;
 };
 
 // bool create_conn_pool(const std::vector<event_base*> contexts,
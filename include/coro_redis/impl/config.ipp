@@ -7,6 +7,12 @@
 //
 #pragma once
 
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
 #ifdef _USE_SPD_LOG
 #   include <logger.hpp>
 #else
@@ -61,6 +67,26 @@ concept RedisSetValueType = std::is_integral<T>::value || is_string<T>::value;
 template <typename T>
 concept StringValueType = is_string<T>::value;
 
+// Range elements are sent by reference, so they must be lvalues or views.
+template <typename T>
+concept RedisArgRef = std::is_lvalue_reference_v<T> ||
+                      std::is_same_v<std::remove_cvref_t<T>, std::string_view>;
+
+template <typename R>
+concept RedisKeyRange =
+    std::ranges::sized_range<R> &&
+    RedisArgRef<std::ranges::range_reference_t<R>> &&
+    std::is_convertible_v<std::ranges::range_reference_t<R>, std::string_view>;
+
+template <typename R>
+concept RedisPairRange =
+    std::ranges::sized_range<R> &&
+    RedisArgRef<std::ranges::range_reference_t<R>> &&
+    requires(std::ranges::range_reference_t<R> kv) {
+      { kv.first } -> std::convertible_to<std::string_view>;
+      { kv.second } -> std::convertible_to<std::string_view>;
+    };
+
 
 enum class UpdateType {
   ALWAYS,
@@ -78,6 +104,10 @@ enum class RedisTTLType {
   PXAT,
   KEEPTTL,
 };
+enum class RedisProtocol {
+  RESP2 = 2,
+  RESP3 = 3,  // negotiated with HELLO 3, requires redis 6
+};
 
 } // namespace coro_redis
 
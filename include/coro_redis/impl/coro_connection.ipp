@@ -7,272 +7,468 @@
 //
 #pragma once
 
+#include <chrono>
 #include <memory>
 
 #include <hiredis/async.h>
 
+#include <coro_redis/context.hpp>
+#include <coro_redis/impl/cancel.ipp>
 #include <coro_redis/impl/config.ipp>
+#include <coro_redis/impl/reader.ipp>
 #include <coro_redis/impl/task.ipp>
 #include <coro_redis/sync_connection.hpp>
 
 namespace coro_redis {
 
+namespace impl {
+
+class coro_connection_impl;
+
+///
+/// @brief Awaiter of one command. Arguments, reply sink and reply are kept
+///   inline with their concrete types, so awaiting a command does not
+///   allocate.
+///
+/// An await may be given a deadline and a cancel token, when either fires
+/// first the coroutine resumes with `std::nullopt`. The command stays queued
+/// on the connection, its reply is dropped when it arrives.
+///
+/// The command is written when it is `co_await`ed, until then its string
+/// arguments are borrowed (see `command_args`). Awaiting in the same
+/// expression is always fine, a stored awaiter needs its strings alive:
+/// @code{.cpp}
+///   co_await conn->get(prefix + id);      // ok
+///   auto a = conn->get(prefix + id);      // the key is gone by the
+///   co_await a;                           // co_await, keep it in a variable
+/// @endcode
+///
+template <typename CORO_RET>
+class command_awaiter {
+public:
+	using reply_op_t = std::function<std::optional<CORO_RET>(redisReply*)>;
+
+	/// Completes at once with nullopt.
+	command_awaiter() = default;
+
+	command_awaiter(const coro_connection_impl* conn, command_args args,
+		reply_op_t op = nullptr)
+		: conn_(conn), args_(std::move(args)), op_(std::move(op)) {}
+
+	///
+	/// @brief Resume with `std::nullopt` if no reply arrived within `timeout`.
+	///
+	/// The timer runs on the loop driving the connection, known for
+	/// connections from `client`, otherwise the loop awaiting the command.
+	/// Without any loop the await fails at once with `std::nullopt`.
+	/// Example: `co_await conn->get("key").with_timeout(5ms);`
+	///
+	command_awaiter with_timeout(std::chrono::milliseconds timeout) && {
+		timeout_ms_ = static_cast<long>(timeout.count());
+		return std::move(*this);
+	}
+
+	///
+	/// @brief Resume with `std::nullopt` if no reply arrived within `timeout`.
+	///
+	/// @param ioc The loop the connection is attached to, the timer and the
+	///   reply must fire on the same thread
+	///
+	command_awaiter with_timeout(std::chrono::milliseconds timeout,
+		const io_context& ioc) && {
+		timeout_ms_ = static_cast<long>(timeout.count());
+		ioc_ = &ioc;
+		return std::move(*this);
+	}
+
+	/// @brief Resume with `std::nullopt` when the token's source is cancelled.
+	command_awaiter with_cancel(cancel_token token) && {
+		cancel_ = std::move(token.state_);
+		return std::move(*this);
+	}
+
+	bool await_ready() const noexcept { return conn_ == nullptr; }
+
+	bool await_suspend(coro::coroutine_handle<> h);
+
+	std::optional<CORO_RET> await_resume() {
+		if (aborted_ != nullptr) {
+			LOG_DEBUG("redis command {}", aborted_);
+			return std::nullopt;
+		}
+		ASSERT_RETURN(reply_ != nullptr, std::nullopt, "redis return null.");
+		if (op_) return op_(reply_);
+		if constexpr (StreamedReply<CORO_RET>) {
+			return sink_.sink.result();
+		} else {
+			return sync_connection_impl::deal_redis_reply<CORO_RET>(reply_);
+		}
+	}
+
+private:
+	// Callback data of an await with a deadline or a token. It outlives the
+	// awaiter when the await is aborted, until the reply arrives.
+	struct guard : cancel_state::node {
+		command_awaiter* owner = nullptr;  // nullptr once aborted
+		const io_context* ioc = nullptr;
+		void* timer = nullptr;
+		std::shared_ptr<cancel_state> cancel;
+
+		void disarm() {
+			if (timer != nullptr) ioc->cancel_timer(timer);
+			timer = nullptr;
+			if (cancel) cancel->unlink(this);
+		}
+	};
+
+	reply_sink* sink() { return op_ ? nullptr : sink_.get(); }
+
+	bool suspend_guarded();
+
+	static void on_reply(redisAsyncContext* actx, void* reply, void* privdata);
+	static void on_guarded_reply(redisAsyncContext* actx, void* reply, void* privdata);
+	static void on_timeout(void* arg);
+	static void on_cancel(cancel_state::node* n);
+	static void abort(guard* g, const char* why);
+	const io_context* timer_context() const;
+
+	const coro_connection_impl* conn_ = nullptr;
+	command_args args_;
+	sink_storage<CORO_RET> sink_;
+	redisReply* reply_ = nullptr;  // valid while the coroutine runs in on_reply
+	coro::coroutine_handle<> h_;
+	reply_op_t op_;
+	long timeout_ms_ = 0;
+	const io_context* ioc_ = nullptr;  // loop of the deadline timer
+	std::shared_ptr<cancel_state> cancel_;
+	const char* aborted_ = nullptr;  // why the await was aborted
+};
+
+} // namespace impl
+
+/// Awaiter returned by the commands, borrows their string arguments until
+/// it is `co_await`ed, see `impl::command_awaiter`.
 template <typename CORO_RET>
-using awaiter_t = task_awaiter<std::optional<CORO_RET>, redisReply*>;
+using awaiter_t = impl::command_awaiter<CORO_RET>;
 
 namespace impl {
 
 class coro_connection_impl {
 public:
-	coro_connection_impl(redisAsyncContext* actx) : redis_ctx_(actx) {}
+	coro_connection_impl(redisAsyncContext* actx,
+		RedisProtocol protocol = RedisProtocol::RESP2,
+		std::string_view user = {}, std::string_view password = {}, int db = 0)
+		: redis_ctx_(actx), protocol_(protocol) {
+		if (actx == nullptr) return;
+		reader_.attach(actx->c.reader);
+		actx->data = this;
+		actx->dataCleanup = &on_context_freed;
+		if (!password.empty()) {
+			prepare(user.empty() ? command_args("auth", password)
+				: command_args("auth", user, password));
+		}
+		if (db != 0) prepare(command_args("select", db));
+		if (protocol == RedisProtocol::RESP3) hello(3);
+	}
+
+	coro_connection_impl(const coro_connection_impl&) = delete;
+	coro_connection_impl& operator=(const coro_connection_impl&) = delete;
+
+	~coro_connection_impl() {
+		if (redis_ctx_ == nullptr) return;
+		redis_ctx_->data = nullptr;
+		redis_ctx_->dataCleanup = nullptr;
+	}
+
+	RedisProtocol protocol() const { return protocol_; }
+
+	size_t pending() const { return reader_.pending(); }
+
+	void set_push_handler(std::function<void(reply_view)> handler) {
+		reader_.set_push_handler(std::move(handler));
+		if (redis_ctx_ == nullptr) return;
+		redisAsyncSetPushCallback(redis_ctx_, [](redisAsyncContext* actx, void* reply) {
+			if (auto* reader = reply_reader::from(actx->c.reader)) {
+				reader->on_push((redisReply*)reply);
+			}
+		});
+	}
+
+	template<typename CORO_RET>
+	awaiter_t<CORO_RET> command(command_args args) const {
+		return awaiter_t<CORO_RET>(this, std::move(args));
+	}
+
+	template<typename CORO_RET>
+	awaiter_t<CORO_RET> command(command_args args, std::function<std::optional<CORO_RET>(redisReply*)>&& reply_op) const {
+		return awaiter_t<CORO_RET>(this, std::move(args), std::move(reply_op));
+	}
 
 	template<typename CORO_RET>
 	awaiter_t<CORO_RET> command(std::string_view cmd) const {
-		return awaiter_t<CORO_RET>(
-			[this, c = std::string(cmd)](awaiter_t<CORO_RET>* awaiter,
-										const coro::coroutine_handle<>& h) {
-			char* pcmd = nullptr;
-			auto cmd_len = redisFormatCommand(&pcmd, c.c_str());
-			redisAsyncFormattedCommand(redis_ctx_, [](struct redisAsyncContext* actx, void* reply, void* pcb_data) {
-				awaiter_t<CORO_RET>* awaiter = reinterpret_cast<awaiter_t<CORO_RET>*>(pcb_data);
-				if (reply) {
-					awaiter->set_coro_return((redisReply*)reply);
-				}
-				awaiter->resume();
-				}, awaiter, pcmd, cmd_len);
-			redisFreeCommand(pcmd);
-		}, [](awaiter_t<CORO_RET>* awaiter, const coro::coroutine_handle<>& h) -> std::optional<CORO_RET> {
-			ASSERT_RETURN(awaiter->coro_return().has_value(), std::nullopt, "redis return null.");
-			return sync_connection_impl::deal_redis_reply<CORO_RET>(awaiter->coro_return().value());
-		});
+		return command<CORO_RET>(command_args::split(cmd));
 	}
 
 	template<typename CORO_RET>
 	awaiter_t<CORO_RET> command(std::string_view cmd, std::function<std::optional<CORO_RET>(redisReply*)>&& reply_op) const {
-		return awaiter_t<CORO_RET>(
-			[this, c = std::string(cmd)](awaiter_t<CORO_RET>* awaiter,
-				const coro::coroutine_handle<>& h) {
-			char* pcmd = nullptr;
-			auto cmd_len = redisFormatCommand(&pcmd, c.c_str());
-			redisAsyncFormattedCommand(redis_ctx_, [](struct redisAsyncContext* actx, void* reply, void* pcb_data) {
-				awaiter_t<CORO_RET>* awaiter = reinterpret_cast<awaiter_t<CORO_RET>*>(pcb_data);
-				if (reply) {
-					awaiter->set_coro_return((redisReply*)reply);
-				}
-				awaiter->resume();
-				}, awaiter, pcmd, cmd_len);
-			redisFreeCommand(pcmd);
-		}, [op = std::move(reply_op)](awaiter_t<CORO_RET>* awaiter, const coro::coroutine_handle<>& h) -> std::optional<CORO_RET> {
-			ASSERT_RETURN(awaiter->coro_return().has_value(), std::nullopt, "redis return null.");
-			if (op == nullptr) return std::nullopt;
-			return op(awaiter->coro_return().value());
-		});
+		return command<CORO_RET>(command_args::split(cmd), std::move(reply_op));
+	}
+
+	template<typename CORO_RET, typename... Args>
+	awaiter_t<CORO_RET> command_argv(std::string_view name, Args&&... args) const {
+		return command<CORO_RET>(command_args(name, std::forward<Args>(args)...));
+	}
+
+	/// Command with compile-time name, its RESP header is precomputed.
+	template<typename CORO_RET, fixed_string NAME, typename... Args>
+	awaiter_t<CORO_RET> command_argv(Args&&... args) const {
+		return command<CORO_RET>(command_args(command_spec<NAME, sizeof...(Args)>{},
+			std::forward<Args>(args)...));
 	}
 
 	inline awaiter_t<scan_ret_t> scan(uint64_t cursor,
 		std::string_view pattern,
 		uint64_t count) {
-		std::string cmd("scan");
-		cmd.append(" ").append(std::to_string(cursor));
+		command_args args("scan", cursor);
 		if (!pattern.empty()) {
-			cmd.append(" MATCH ").append(pattern);
+			args.append("MATCH").append(pattern);
 		}
 		if (count > 0) {
-			cmd.append(" COUNT ").append(std::to_string(count));
+			args.append("COUNT").append(count);
 		}
-		return send_scan_cmd(cmd);
+		return send_scan_cmd(std::move(args));
 	}
 
 	awaiter_t<scan_ret_t> hscan(std::string_view key,
 		uint64_t cursor,
 		std::string_view pattern,
 		uint64_t count) {
-		std::string cmd("hscan");
-		cmd.append(" ").append(key);
-		cmd.append(" ").append(std::to_string(cursor));
-		if (!pattern.empty()) {
-			cmd.append(" MATCH ").append(pattern);
-		}
-		if (count > 0) {
-			cmd.append(" COUNT ").append(std::to_string(count));
-		}
-		return send_scan_cmd(cmd);
+		return send_scan_cmd(sync_connection_impl::scan_args("hscan", key, cursor, pattern, count));
 	}
 
 	awaiter_t<scan_ret_t> sscan(std::string_view key,
 		uint64_t cursor,
 		std::string_view pattern,
 		uint64_t count) {
-		std::string cmd("sscan");
-		cmd.append(" ").append(key);
-		cmd.append(" ").append(std::to_string(cursor));
-		if (!pattern.empty()) {
-			cmd.append(" MATCH ").append(pattern);
-		}
-		if (count > 0) {
-			cmd.append(" COUNT ").append(std::to_string(count));
-		}
-		return send_scan_cmd(cmd);
+		return send_scan_cmd(sync_connection_impl::scan_args("sscan", key, cursor, pattern, count));
 	}
 
 	awaiter_t<scan_ret_t> zscan(std::string_view key,
 		uint64_t cursor,
 		std::string_view pattern,
 		uint64_t count) {
-		std::string cmd("zscan");
-		cmd.append(" ").append(key);
-		cmd.append(" ").append(std::to_string(cursor));
-		if (!pattern.empty()) {
-			cmd.append(" MATCH ").append(pattern);
-		}
-		if (count > 0) {
-			cmd.append(" COUNT ").append(std::to_string(count));
-		}
-		return send_scan_cmd(cmd);
-	}
-
-	awaiter_t<scan_ret_t> send_scan_cmd(std::string_view cmd) {
-		return command<scan_ret_t>(cmd, [](redisReply* reply) -> std::optional<scan_ret_t> {
-			scan_ret_t ret;
-			ASSERT_RETURN(reply->type == REDIS_REPLY_ARRAY, ret, "scan result type not match, {}", reply->type);
-			ASSERT_RETURN(reply->elements == 2, ret, "scan result element count not 2, {}", reply->elements);
-			auto elem_0 = reply->element[0];
-			ASSERT_RETURN(elem_0->type == REDIS_REPLY_STRING, ret, "scan element[0] type not string, {}", elem_0->type);
-			ASSERT_RETURN(elem_0->len > 0, ret, "scan element[0] is null, {}", elem_0->len);
-			ret.first = std::stoll(std::string(elem_0->str, elem_0->len));
-			auto elem_1 = reply->element[1];
-			ASSERT_RETURN(elem_1->type == REDIS_REPLY_ARRAY, ret, "scan element[1] type not match, {}", elem_1->type);
-			for (size_t i = 0; i < elem_1->elements; ++i)
-			{
-				if (elem_1->element[i]->type != REDIS_REPLY_STRING) {
-					ret.second.push_back("");
-				}
-				else {
-					ret.second.push_back(std::string(elem_1->element[i]->str, elem_1->element[i]->len));
-				}
-			}
-			return ret;
-			});
+		return send_scan_cmd(sync_connection_impl::scan_args("zscan", key, cursor, pattern, count));
 	}
-	template<RedisSetValueType T>
+
+	awaiter_t<scan_ret_t> send_scan_cmd(command_args args) {
+		return command<scan_ret_t>(std::move(args));
+	}
+
+	template<typename T>
+		requires RedisSetValueType<std::remove_cvref_t<T>>
 	awaiter_t<std::string> set(std::string_view key,
-		T val,
+		T&& val,
 		uint64_t ttl,
 		RedisTTLType ttl_type,
 		UpdateType type) {
-		std::string cmd(fmt::format("set {} {}", key, val));
-		if (ttl > 0 && ttl_type != RedisTTLType::KEEPTTL) {
-			switch (ttl_type) {
-			case RedisTTLType::EX: cmd.append(" EX "); break;
-			case RedisTTLType::PX: cmd.append(" PX "); break;
-			case RedisTTLType::EXAT: cmd.append(" EXAT "); break;
-			case RedisTTLType::PXAT: cmd.append(" PXAT "); break;
-			case RedisTTLType::KEEPTTL: break;
-			}
-			cmd.append(std::to_string(ttl));
-		}
-		if (ttl_type == RedisTTLType::KEEPTTL) {
-			cmd.append(" KEEPTTL ");
-		}
-		switch (type) {
-		case UpdateType::EXIST: cmd.append(" XX "); break;
-		case UpdateType::NOT_EXIST: cmd.append(" NX "); break;
-		default: break;
-		}
-		return command<std::string>(std::move(cmd));
+		return command<std::string>(sync_connection_impl::set_args(key, std::forward<T>(val), ttl, ttl_type, type));
 	}
 
 	awaiter_t<uint64_t> hset(std::string_view key, const std::vector<std::pair<std::string_view, std::string_view>>& kvs) {
-		std::string cmd("hset");
-		cmd.append(" ").append(key);
-		for (const auto& kv : kvs)
-		{
-			cmd.append(" ").append(kv.first);
-			cmd.append(" ").append(kv.second);
-		}
-		return command<uint64_t>(std::move(cmd));
+		return command<uint64_t>(sync_connection_impl::hset_args(key, kvs));
 	}
 
 	awaiter_t<uint64_t> zadd(std::string_view key,
 		std::string_view member,
 		double score,
 		UpdateType type) {
-		std::string cmd("zadd");
-		cmd.append(" ").append(key);
-		switch (type)
-		{
-		case UpdateType::EXIST: cmd.append(" XX ");	break;
-		case UpdateType::NOT_EXIST:	cmd.append(" NX "); break;
-		case UpdateType::LESS_THAN:	cmd.append(" LT "); break;
-		case UpdateType::GREATE_THAN: cmd.append(" GT "); break;
-		case UpdateType::CHANGED: cmd.append(" CH "); break;
-		case UpdateType::INCR: cmd.append(" INCR "); break;
-		case UpdateType::ALWAYS: break;
-		}
-		cmd.append(" ").append(std::to_string(score));
-		cmd.append(" ").append(member);
-		return command<uint64_t>(std::move(cmd));
+		command_args args("zadd", key);
+		sync_connection_impl::append_update_type(args, type);
+		args.append(score).append(member);
+		return command<uint64_t>(std::move(args));
 	}
 
 	awaiter_t<uint64_t> zadd(std::string_view key,
 		std::vector<std::pair<std::string_view, double>> kvs,
 		UpdateType type) {
-		std::string cmd("zadd");
-		cmd.append(" ").append(key);
-		switch (type)
-		{
-		case UpdateType::EXIST: cmd.append(" XX ");	break;
-		case UpdateType::NOT_EXIST:	cmd.append(" NX "); break;
-		case UpdateType::LESS_THAN:	cmd.append(" LT "); break;
-		case UpdateType::GREATE_THAN: cmd.append(" GT "); break;
-		case UpdateType::CHANGED: cmd.append(" CH "); break;
-		case UpdateType::INCR: cmd.append(" INCR "); break;
-		default: break;
-		}
-		for (const auto& kv : kvs)
-		{
-			cmd.append(" ").append(std::to_string(kv.second));
-			cmd.append(" ").append(kv.first);
-		}
-		return command<uint64_t>(std::move(cmd));
+		return command<uint64_t>(sync_connection_impl::zadd_args(key, kvs, type));
 	}
 
 	awaiter_t<uint64_t> zunionstore(std::string_view destination,
 		std::initializer_list<std::string_view> keys, std::string_view aggregate) {
 		if (keys.size() == 0) return {};
-
-		std::string cmd("zadd");
-		cmd.append(" ").append(destination);
-		cmd.append(" ").append(std::to_string(keys.size()));
-		for (const auto& key : keys)
-		{
-			cmd.append(" ").append(key);
-		}
-		cmd.append(" ").append(aggregate);
-		return command<uint64_t>(std::move(cmd));
+		return command<uint64_t>(sync_connection_impl::zunionstore_args(destination, keys, aggregate));
 	}
 
 	awaiter_t<uint64_t> zunionstore(std::string_view destination,
 		std::vector<std::pair<std::string_view, double>> kvs, std::string_view aggregate) {
 		if (kvs.size() == 0) return {};
+		return command<uint64_t>(sync_connection_impl::zunionstore_args(destination, kvs, aggregate));
+	}
 
-		std::string cmd("zadd");
-		cmd.append(" ").append(destination);
-		cmd.append(" ").append(std::to_string(kvs.size()));
-		for (const auto& kv : kvs)
-		{
-			cmd.append(" ").append(kv.first);
+	/// Write one command, `fn` gets its reply, nullptr if the connection is
+	/// lost, and must call `reply_done` first.
+	bool send(const command_args& args, redisCallbackFn* fn, void* privdata,
+		reply_sink* sink = nullptr) const {
+		if (redis_ctx_ == nullptr) {
+			LOG_ERROR("send redis command failed, connection lost");
+			return false;
 		}
-		cmd.append(" WEIGHTS ");
-		for (const auto& kv : kvs)
-		{
-			cmd.append(" ").append(std::to_string(kv.second));
+		writer_.clear();
+		writer_.write(args);
+		auto ret = redisAsyncFormattedCommand(redis_ctx_, fn, privdata, writer_.data(), writer_.size());
+		if (ret != REDIS_OK) {
+			LOG_ERROR("send redis command failed, {}", redis_ctx_->errstr ? redis_ctx_->errstr : "");
+			return false;
 		}
-		cmd.append(" ").append(aggregate);
-		return command<uint64_t>(std::move(cmd));
+		reader_.push(sink);
+		return true;
 	}
+
+	/// Encoded size of the last command written by `send`.
+	size_t written() const { return writer_.size(); }
+
+	/// Loop the connection is attached to, nullptr if unknown.
+	const io_context* context() const { return ioc_; }
+	void set_context(const io_context* ioc) { ioc_ = ioc; }
+
+	/// The reply of a queued command is no longer wanted, its sink goes away.
+	void abandon(reply_sink* sink) const { reader_.abandon(sink); }
+
+	static void reply_done(redisAsyncContext* actx) {
+		if (auto* reader = reply_reader::from(actx->c.reader)) reader->pop();
+	}
+
 private:
+	// hiredis frees the context and its reader on disconnect, QUIT or a
+	// timeout, after failing the queued commands.
+	static void on_context_freed(void* privdata) {
+		auto* self = static_cast<coro_connection_impl*>(privdata);
+		self->reader_.forget();
+		self->redis_ctx_ = nullptr;
+	}
+
+	// Queued ahead of every user command, a failure is only logged.
+	void prepare(const command_args& args) const {
+		send(args, [](struct redisAsyncContext* actx, void* reply, void*) {
+			reply_done(actx);
+			auto* r = (redisReply*)reply;
+			if (r == nullptr || r->type == REDIS_REPLY_ERROR) {
+				LOG_ERROR("redis connection setup failed, {}",
+					r ? std::string(r->str, r->len) : std::string("no reply"));
+			}
+			}, nullptr);
+	}
+
+	// Queued ahead of every user command, so all their replies are RESP3.
+	void hello(int protover) {
+		send(command_args("hello", protover), [](struct redisAsyncContext* actx, void* reply, void*) {
+			reply_done(actx);
+			auto* r = (redisReply*)reply;
+			if (r == nullptr || r->type != REDIS_REPLY_MAP) {
+				LOG_ERROR("switch to RESP3 failed, server may be older than 6.0");
+			}
+			}, nullptr);
+	}
+
 	redisAsyncContext* redis_ctx_ = nullptr;                  // redis contex
+	const io_context* ioc_ = nullptr;                         // loop delivering the replies
+	RedisProtocol protocol_ = RedisProtocol::RESP2;
+	mutable resp_writer writer_;                              // reusable command buffer
+	mutable reply_reader reader_;                             // decodes replies of queued sinks
 }; // class connection_impl
+
+template <typename CORO_RET>
+bool command_awaiter<CORO_RET>::await_suspend(coro::coroutine_handle<> h) {
+	h_ = h;
+	if (timeout_ms_ > 0 || cancel_) return suspend_guarded();
+	// a custom reply op reads the reply tree
+	return conn_->send(args_, &on_reply, this, sink());
+}
+
+template <typename CORO_RET>
+bool command_awaiter<CORO_RET>::suspend_guarded() {
+	if (cancel_ && cancel_->cancelled()) {
+		aborted_ = "cancelled";
+		return false;
+	}
+	auto* g = new guard;
+	// armed first, it can only fire once this loop runs again
+	if (timeout_ms_ > 0) {
+		g->ioc = timer_context();
+		if (g->ioc != nullptr) {
+			g->timer = g->ioc->add_timer(timeout_ms_, &on_timeout, g);
+		}
+		if (g->timer == nullptr) {
+			delete g;
+			LOG_ERROR("no loop with timers for the command deadline, pass the io_context to with_timeout");
+			aborted_ = "has no deadline timer";
+			return false;
+		}
+	}
+	if (!conn_->send(args_, &on_guarded_reply, g, sink())) {
+		g->disarm();
+		delete g;
+		return false;
+	}
+	g->owner = this;
+	if (cancel_) {
+		g->cancel = cancel_;
+		g->on_cancel = &on_cancel;
+		cancel_->link(g);
+	}
+	return true;
+}
+
+// The reply callback runs on the connection's loop, so does the timer.
+template <typename CORO_RET>
+const io_context* command_awaiter<CORO_RET>::timer_context() const {
+	if (ioc_ != nullptr) return ioc_;
+	if (conn_->context() != nullptr) return conn_->context();
+	return io_context::current();
+}
+
+template <typename CORO_RET>
+void command_awaiter<CORO_RET>::on_reply(redisAsyncContext* actx, void* reply, void* privdata) {
+	coro_connection_impl::reply_done(actx);
+	auto* self = static_cast<command_awaiter*>(privdata);
+	self->reply_ = (redisReply*)reply;
+	self->h_.resume();
+}
+
+template <typename CORO_RET>
+void command_awaiter<CORO_RET>::on_guarded_reply(redisAsyncContext* actx, void* reply, void* privdata) {
+	coro_connection_impl::reply_done(actx);
+	auto* g = static_cast<guard*>(privdata);
+	auto* self = g->owner;
+	g->disarm();
+	delete g;
+	if (self == nullptr) return;  // aborted, the reply is dropped
+	self->reply_ = (redisReply*)reply;
+	self->h_.resume();
+}
+
+template <typename CORO_RET>
+void command_awaiter<CORO_RET>::on_timeout(void* arg) {
+	auto* g = static_cast<guard*>(arg);
+	g->timer = nullptr;  // released by the context
+	abort(g, "timed out, its reply will be dropped");
+}
+
+template <typename CORO_RET>
+void command_awaiter<CORO_RET>::on_cancel(cancel_state::node* n) {
+	abort(static_cast<guard*>(n), "cancelled, its reply will be dropped");
+}
+
+template <typename CORO_RET>
+void command_awaiter<CORO_RET>::abort(guard* g, const char* why) {
+	auto* self = g->owner;
+	g->disarm();
+	g->owner = nullptr;
+	// the sink lives in the awaiter, which is gone once the coroutine resumes
+	self->conn_->abandon(self->sink());
+	self->aborted_ = why;
+	self->h_.resume();
+}
 } // namespace impl
 } // namespace coro_redis
\ No newline at end of file
@@ -0,0 +1,184 @@
+//
+// Copyright (c) 2020 Gu.Qiwei(gqwmail@qq.com)
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+namespace coro_redis {
+namespace impl {
+
+///
+/// @brief Per-thread cache of coroutine frames, one free list per size class.
+///
+/// Frames up to `kMaxPooled` bytes are rounded up to a multiple of
+/// `kGranularity` and recycled, larger ones go to the global `operator new`.
+/// A frame freed on another thread than the one which allocated it simply
+/// joins the cache of the freeing thread. Define `CORO_REDIS_NO_FRAME_POOL`
+/// to bypass the cache, e.g. when running under a leak checker.
+///
+class frame_pool {
+ public:
+  static constexpr size_t kGranularity = 64;
+  static constexpr size_t kClasses = 16;
+  static constexpr size_t kMaxPooled = kGranularity * kClasses;  // 1 KiB
+  static constexpr size_t kMaxCached = 256;  // per size class and thread
+
+  static void* allocate(size_t n) {
+#ifndef CORO_REDIS_NO_FRAME_POOL
+    if (n != 0 && n <= kMaxPooled) {
+      auto& c = cache_;
+      auto idx = (n - 1) / kGranularity;
+      if (auto* b = c.heads[idx]) {
+        c.heads[idx] = b->next;
+        --c.counts[idx];
+        return b;
+      }
+      if (!c.closed) guard_.touch();  // flush the cache at thread exit
+      return ::operator new((idx + 1) * kGranularity);
+    }
+#endif
+    return ::operator new(n);
+  }
+
+  static void deallocate(void* p, size_t n) noexcept {
+#ifndef CORO_REDIS_NO_FRAME_POOL
+    if (n != 0 && n <= kMaxPooled) {
+      auto& c = cache_;
+      auto idx = (n - 1) / kGranularity;
+      if (!c.closed && c.counts[idx] < kMaxCached) {
+        c.heads[idx] = new (p) block{c.heads[idx]};
+        ++c.counts[idx];
+        return;
+      }
+    }
+#endif
+    ::operator delete(p);
+  }
+
+ private:
+  struct block {
+    block* next;
+  };
+
+  // Trivially destructible, so frames freed during thread exit after the
+  // guard ran still find a valid (closed) cache.
+  struct cache {
+    block* heads[kClasses];
+    uint32_t counts[kClasses];
+    bool closed;
+  };
+
+  struct cache_guard {
+    void touch() {}
+    ~cache_guard() {
+      auto& c = cache_;
+      c.closed = true;
+      for (size_t i = 0; i < kClasses; ++i) {
+        while (auto* b = c.heads[i]) {
+          c.heads[i] = b->next;
+          ::operator delete(b);
+        }
+        c.counts[i] = 0;
+      }
+    }
+  };
+
+  static inline thread_local cache cache_{};
+  static inline thread_local cache_guard guard_;
+};
+
+// Trailer stored behind a frame, tells how it is released.
+using frame_release_fn = void (*)(void* frame, size_t n);
+
+constexpr size_t frame_align_up(size_t n, size_t align) {
+  return (n + align - 1) & ~(align - 1);
+}
+
+///
+/// @brief `operator new/delete` of coroutine promises.
+///
+/// By default the frame comes from `frame_pool`. A coroutine whose parameters
+/// start with `std::allocator_arg, alloc` (after the object parameter for
+/// member functions) is allocated with a copy of `alloc` instead.
+///
+class frame_allocation {
+ public:
+  static void* operator new(size_t n) {
+    auto off = frame_align_up(n, alignof(frame_release_fn));
+    auto* p = frame_pool::allocate(off + sizeof(frame_release_fn));
+    new (static_cast<std::byte*>(p) + off) frame_release_fn(&release_pooled);
+    return p;
+  }
+
+  template <typename Alloc, typename... Args>
+  static void* operator new(size_t n, std::allocator_arg_t, const Alloc& alloc,
+                            const Args&...) {
+    return allocate_with(n, alloc);
+  }
+
+  template <typename Self, typename Alloc, typename... Args>
+  static void* operator new(size_t n, const Self&, std::allocator_arg_t,
+                            const Alloc& alloc, const Args&...) {
+    return allocate_with(n, alloc);
+  }
+
+  static void operator delete(void* p, size_t n) noexcept {
+    auto off = frame_align_up(n, alignof(frame_release_fn));
+    auto release = *std::launder(reinterpret_cast<frame_release_fn*>(
+        static_cast<std::byte*>(p) + off));
+    release(p, n);
+  }
+
+ private:
+  template <typename Alloc>
+  using byte_alloc_t =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<std::byte>;
+
+  // Frame, release function, then the allocator copy.
+  template <typename Alloc>
+  static constexpr size_t alloc_offset(size_t n) {
+    auto off = frame_align_up(n, alignof(frame_release_fn));
+    return frame_align_up(off + sizeof(frame_release_fn),
+                          alignof(byte_alloc_t<Alloc>));
+  }
+
+  template <typename Alloc>
+  static void* allocate_with(size_t n, const Alloc& alloc) {
+    using byte_alloc = byte_alloc_t<Alloc>;
+    byte_alloc a(alloc);
+    auto aoff = alloc_offset<Alloc>(n);
+    auto total = aoff + sizeof(byte_alloc);
+    auto* p = std::allocator_traits<byte_alloc>::allocate(a, total);
+    auto off = frame_align_up(n, alignof(frame_release_fn));
+    new (p + off) frame_release_fn(&release_with<Alloc>);
+    new (p + aoff) byte_alloc(std::move(a));
+    return p;
+  }
+
+  static void release_pooled(void* p, size_t n) {
+    auto off = frame_align_up(n, alignof(frame_release_fn));
+    frame_pool::deallocate(p, off + sizeof(frame_release_fn));
+  }
+
+  template <typename Alloc>
+  static void release_with(void* frame, size_t n) {
+    using byte_alloc = byte_alloc_t<Alloc>;
+    auto* p = static_cast<std::byte*>(frame);
+    auto aoff = alloc_offset<Alloc>(n);
+    auto* stored = std::launder(reinterpret_cast<byte_alloc*>(p + aoff));
+    byte_alloc a(std::move(*stored));
+    stored->~byte_alloc();
+    std::allocator_traits<byte_alloc>::deallocate(a, p, aoff + sizeof(byte_alloc));
+  }
+};
+
+}  // namespace impl
+}  // namespace coro_redis
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2020 Gu.Qiwei(gqwmail@qq.com)
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+//
+#pragma once
+
+#include <array>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <coro_redis/impl/coro_connection.ipp>
+
+namespace coro_redis {
+namespace impl {
+
+///
+/// @brief Typed commands sent in one batch, the coroutine is resumed once
+///   when the last reply arrives.
+///
+/// Example:
+/// @code{.cpp}
+/// auto [val, count, ok] = co_await conn->pipeline()
+///     .command<std::string>("get", "key")
+///     .command<uint64_t>("hincrby", "hash", "field", 1)
+///     .command<uint64_t>("expire", "key", 60);
+/// @endcode
+///
+template <typename... Ts>
+class pipeline_awaiter {
+  static_assert((!std::is_same_v<Ts, reply_view> && ...),
+                "reply_view does not outlive the reply callback");
+
+ public:
+  using result_type = std::tuple<std::optional<Ts>...>;
+
+  explicit pipeline_awaiter(const coro_connection_impl* conn,
+                            std::vector<command_args> cmds = {})
+      : conn_(conn), cmds_(std::move(cmds)) {}
+
+  /// @brief Append a command, its reply is decoded as `T`.
+  template <typename T, typename... Args>
+  pipeline_awaiter<Ts..., T> command(std::string_view name, Args&&... args) && {
+    cmds_.emplace_back(name, std::forward<Args>(args)...);
+    return pipeline_awaiter<Ts..., T>(conn_, std::move(cmds_));
+  }
+
+  bool await_ready() const noexcept { return sizeof...(Ts) == 0; }
+
+  bool await_suspend(coro::coroutine_handle<> h) {
+    h_ = h;
+    send_all(std::index_sequence_for<Ts...>{});
+    return remaining_ > 0;  // nothing sent, resume right away
+  }
+
+  result_type await_resume() { return std::move(results_); }
+
+ private:
+  struct slot {
+    pipeline_awaiter* self;
+    void (*decode)(pipeline_awaiter*, redisReply*);
+  };
+
+  template <size_t... Is>
+  void send_all(std::index_sequence<Is...>) {
+    (send_one<Is>(), ...);
+  }
+
+  template <size_t I>
+  void send_one() {
+    slots_[I] = slot{this, &decode<I>};
+    auto* sink = std::get<I>(sinks_).get();
+    if (conn_->send(cmds_[I], &on_reply, &slots_[I], sink)) ++remaining_;
+  }
+
+  template <size_t I>
+  static void decode(pipeline_awaiter* self, redisReply* reply) {
+    using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+    if (reply == nullptr) return;
+    if constexpr (StreamedReply<T>) {
+      std::get<I>(self->results_) = std::get<I>(self->sinks_).sink.result();
+    } else {
+      std::get<I>(self->results_) =
+          sync_connection_impl::deal_redis_reply<T>(reply);
+    }
+  }
+
+  static void on_reply(redisAsyncContext* actx, void* reply, void* privdata) {
+    coro_connection_impl::reply_done(actx);
+    auto* s = static_cast<slot*>(privdata);
+    s->decode(s->self, (redisReply*)reply);
+    if (--s->self->remaining_ == 0) s->self->h_.resume();
+  }
+
+  const coro_connection_impl* conn_ = nullptr;
+  std::vector<command_args> cmds_;
+  std::array<slot, sizeof...(Ts)> slots_{};
+  std::tuple<sink_storage<Ts>...> sinks_;
+  result_type results_;
+  size_t remaining_ = 0;
+  coro::coroutine_handle<> h_;
+};
+
+}  // namespace impl
+
+template <typename... Ts>
+using pipeline_t = impl::pipeline_awaiter<Ts...>;
+
+}  // namespace coro_redis
@@ -0,0 +1,460 @@
+//
+// Copyright (c) 2020 Gu.Qiwei(gqwmail@qq.com)
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+//
+#pragma once
+
+#include <charconv>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <hiredis/hiredis.h>
+#include <coro_redis/impl/config.ipp>
+#include <coro_redis/impl/reply.ipp>
+
+namespace coro_redis {
+namespace impl {
+
+///
+/// @brief Receives the parse events of one reply, instead of hiredis building
+///   a `redisReply` tree for it.
+///
+class reply_sink {
+ public:
+  virtual ~reply_sink() = default;
+  virtual void on_array(const redisReadTask* task, size_t elements) = 0;
+  virtual void on_string(const redisReadTask* task, std::string_view str) = 0;
+  virtual void on_integer(const redisReadTask* task, long long val) = 0;
+  virtual void on_nil(const redisReadTask* task) = 0;
+
+ protected:
+  static bool is_root(const redisReadTask* task) {
+    return task->parent == nullptr;
+  }
+};
+
+template <typename T>
+concept SequenceReply = requires(T& c) {
+  typename T::value_type;
+  c.reserve(size_t{});
+  c.emplace_back();
+};
+
+template <typename T>
+concept MapReply = requires(T& c) {
+  typename T::key_type;
+  typename T::mapped_type;
+  c.emplace(std::declval<typename T::key_type>(),
+            std::declval<typename T::mapped_type>());
+};
+
+template <typename T>
+struct is_pair : std::false_type {};
+template <typename K, typename V>
+struct is_pair<std::pair<K, V>> : std::true_type {};
+
+/// @brief Convert one reply string to a container element.
+template <typename V>
+bool parse_reply_value(std::string_view str, V& val) {
+  if constexpr (std::is_same_v<V, std::string>) {
+    val.assign(str.data(), str.size());
+    return true;
+  } else {
+    auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), val);
+    return ec == std::errc();
+  }
+}
+
+///
+/// @brief Describes how an array reply is decoded into `T`, specialize it to
+///   decode replies into other containers.
+///
+/// `stride` reply elements make up one item, e.g. 2 for field-value pairs.
+/// `reserve` is called once with the item count before the first `append`,
+/// `append` gets the `stride` elements of one item and returns false if they
+/// can not be converted.
+///
+template <typename T>
+struct reply_traits {};
+
+template <typename T>
+  requires(SequenceReply<T> && !is_pair<typename T::value_type>::value)
+struct reply_traits<T> {
+  static constexpr size_t stride = 1;
+
+  static void reserve(T& c, size_t n) { c.reserve(n); }
+
+  static bool append(T& c, const std::string_view* items) {
+    auto& val = c.emplace_back();
+    return parse_reply_value(items[0], val);
+  }
+};
+
+template <typename T>
+  requires(SequenceReply<T> && is_pair<typename T::value_type>::value)
+struct reply_traits<T> {
+  static constexpr size_t stride = 2;
+
+  static void reserve(T& c, size_t n) { c.reserve(n); }
+
+  static bool append(T& c, const std::string_view* items) {
+    auto& kv = c.emplace_back();
+    return parse_reply_value(items[0], kv.first) &&
+           parse_reply_value(items[1], kv.second);
+  }
+};
+
+template <typename T>
+  requires(MapReply<T> && !SequenceReply<T>)
+struct reply_traits<T> {
+  static constexpr size_t stride = 2;
+
+  static void reserve(T& c, size_t n) {
+    if constexpr (requires { c.reserve(n); }) c.reserve(n);
+  }
+
+  static bool append(T& c, const std::string_view* items) {
+    typename T::key_type key{};
+    typename T::mapped_type val{};
+    if (!parse_reply_value(items[0], key) || !parse_reply_value(items[1], val)) {
+      return false;
+    }
+    c.emplace(std::move(key), std::move(val));
+    return true;
+  }
+};
+
+template <>
+struct reply_traits<reply_arena> {
+  static constexpr size_t stride = 1;
+
+  static void reserve(reply_arena& c, size_t n) { c.reserve(n); }
+
+  static bool append(reply_arena& c, const std::string_view* items) {
+    c.push_back(items[0]);
+    return true;
+  }
+};
+
+/// Reply elements per item of `T`, 1 for types without `reply_traits`, e.g.
+/// `reply_view`, which read the reply as it is.
+template <typename T>
+inline constexpr size_t reply_stride_v = 1;
+
+template <typename T>
+  requires requires { reply_traits<T>::stride; }
+inline constexpr size_t reply_stride_v<T> = reply_traits<T>::stride;
+
+///
+/// @brief Decodes an array reply into a container through `reply_traits`.
+///
+/// Nil and integer elements are passed on as empty and decimal strings.
+/// Nested arrays are flattened, so RESP3 `[member, score]` pairs decode the
+/// same way as the RESP2 flat list.
+///
+template <typename T>
+class container_sink final : public reply_sink {
+  using traits = reply_traits<T>;
+
+ public:
+  void on_array(const redisReadTask* task, size_t elements) override {
+    if (!is_root(task)) return;
+    ok_ = true;
+    traits::reserve(value_, elements / traits::stride);
+  }
+
+  void on_string(const redisReadTask* task, std::string_view str) override {
+    if (is_root(task)) {
+      if (task->type == REDIS_REPLY_ERROR) {
+        LOG_ERROR("redis reply error, {}", std::string(str));
+      }
+      return;
+    }
+    add(str);
+  }
+
+  void on_integer(const redisReadTask* task, long long val) override {
+    if (is_root(task)) return;
+    char tmp[24];
+    auto [end, ec] = std::to_chars(tmp, tmp + sizeof(tmp), val);
+    add(std::string_view(tmp, end - tmp));
+  }
+
+  void on_nil(const redisReadTask* task) override {
+    if (is_root(task)) return;
+    add({});
+  }
+
+  std::optional<T> result() {
+    if (!ok_ || !ok_value_) return std::nullopt;
+    return std::move(value_);
+  }
+
+ private:
+  void add(std::string_view str) {
+    if constexpr (traits::stride == 1) {
+      ok_value_ &= traits::append(value_, &str);
+    } else if (!has_key_) {
+      // the reader buffer may be compacted before the value arrives
+      key_.assign(str.data(), str.size());
+      has_key_ = true;
+    } else {
+      std::string_view items[] = {key_, str};
+      ok_value_ &= traits::append(value_, items);
+      has_key_ = false;
+    }
+  }
+
+  T value_;
+  std::string key_;
+  bool has_key_ = false;
+  bool ok_ = false;
+  bool ok_value_ = true;
+};
+
+///
+/// @brief Decodes `[cursor, [elements...]]` replies of the scan commands.
+///
+class scan_sink final : public reply_sink {
+  using traits = reply_traits<std::vector<std::string>>;
+
+ public:
+  void on_array(const redisReadTask* task, size_t elements) override {
+    if (is_root(task)) {
+      ok_ = elements == 2;
+    } else if (task->idx == 1) {
+      traits::reserve(value_.second, elements);
+    }
+  }
+
+  void on_string(const redisReadTask* task, std::string_view str) override {
+    if (is_root(task)) {
+      if (task->type == REDIS_REPLY_ERROR) {
+        LOG_ERROR("redis reply error, {}", std::string(str));
+      }
+    } else if (is_root(task->parent)) {
+      ok_cursor_ = task->idx == 0 && parse_reply_value(str, value_.first);
+    } else {
+      traits::append(value_.second, &str);
+    }
+  }
+
+  void on_integer(const redisReadTask* task, long long val) override {}
+
+  void on_nil(const redisReadTask* task) override {
+    if (!is_root(task) && !is_root(task->parent)) value_.second.emplace_back();
+  }
+
+  std::optional<scan_ret_t> result() {
+    if (!ok_ || !ok_cursor_) return std::nullopt;
+    return std::move(value_);
+  }
+
+ private:
+  scan_ret_t value_;
+  bool ok_ = false;
+  bool ok_cursor_ = false;
+};
+
+template <typename T>
+struct reply_sink_of {
+  using type = container_sink<T>;
+};
+
+template <>
+struct reply_sink_of<scan_ret_t> {
+  using type = scan_sink;
+};
+
+/// @brief Replies decoded straight into the container, without a reply tree.
+template <typename T>
+concept StreamedReply =
+    std::is_same_v<T, scan_ret_t> || requires { reply_traits<T>::stride; };
+
+template <typename T>
+using reply_sink_t = typename reply_sink_of<T>::type;
+
+/// @brief Sink member of awaiters, empty for replies kept as a reply tree.
+template <typename T>
+struct sink_storage {
+  reply_sink* get() { return nullptr; }
+};
+
+template <StreamedReply T>
+struct sink_storage<T> {
+  reply_sink* get() { return &sink; }
+
+  reply_sink_t<T> sink;
+};
+
+///
+/// @brief Replaces the hiredis reader object functions of one connection.
+///
+/// Every command sent on the connection queues the sink its reply goes to,
+/// replies arrive in the same order. Commands without a sink get the usual
+/// `redisReply` tree; a sink reply returns `decoded()` to hiredis instead.
+///
+class reply_reader {
+ public:
+  reply_reader() = default;
+  reply_reader(const reply_reader&) = delete;
+  reply_reader& operator=(const reply_reader&) = delete;
+  ~reply_reader() { detach(); }
+
+  void attach(redisReader* reader) {
+    if (reader == nullptr) return;
+    reader_ = reader;
+    default_fn_ = reader->fn;
+    reader->fn = &functions_;
+    reader->privdata = this;
+  }
+
+  void detach() {
+    if (reader_ == nullptr) return;
+    reader_->fn = default_fn_;
+    reader_->privdata = nullptr;
+    reader_ = nullptr;
+  }
+
+  /// @brief hiredis freed the reader with its context, drop it untouched.
+  void forget() {
+    reader_ = nullptr;
+    pending_.clear();
+  }
+
+  /// @brief Queue the sink of the next sent command, nullptr for a tree.
+  void push(reply_sink* sink) {
+    if (reader_ != nullptr) pending_.push_back(sink);
+  }
+
+  /// @brief The front command got its reply.
+  void pop() {
+    if (!pending_.empty()) pending_.pop_front();
+  }
+
+  /// @brief Commands waiting for their reply.
+  size_t pending() const { return pending_.size(); }
+
+  /// @brief The awaiter owning `sink` went away, its reply is parsed and
+  ///   dropped.
+  void abandon(reply_sink* sink) {
+    if (sink == nullptr) return;
+    for (auto& p : pending_) {
+      if (p == sink) {
+        p = &discard_;
+        return;
+      }
+    }
+  }
+
+  static reply_reader* from(redisReader* reader) {
+    if (reader == nullptr || reader->fn != &functions_) return nullptr;
+    return static_cast<reply_reader*>(reader->privdata);
+  }
+
+  /// @brief Handler of RESP3 push messages, e.g. client side caching
+  ///   invalidations.
+  void set_push_handler(std::function<void(reply_view)> handler) {
+    push_handler_ = std::move(handler);
+  }
+
+  void on_push(redisReply* reply) {
+    if (push_handler_) push_handler_(reply_view(reply));
+  }
+
+  /// @brief Placeholder reply handed to hiredis for sink decoded replies.
+  static redisReply* decoded() { return &decoded_; }
+
+ private:
+  static reply_sink* sink_of(const redisReadTask* task) {
+    auto* self = static_cast<reply_reader*>(task->privdata);
+    if (self->pending_.empty()) return nullptr;
+    // out of band push messages are not replies of queued commands
+    auto* root = task;
+    while (root->parent != nullptr) root = root->parent;
+    if (root->type == REDIS_REPLY_PUSH) return nullptr;
+    return self->pending_.front();
+  }
+
+  static const redisReplyObjectFunctions* fallback(const redisReadTask* task) {
+    return static_cast<reply_reader*>(task->privdata)->default_fn_;
+  }
+
+  static void* create_string(const redisReadTask* task, char* str,
+                             size_t len) {
+    auto* sink = sink_of(task);
+    if (sink == nullptr) return fallback(task)->createString(task, str, len);
+    sink->on_string(task, std::string_view(str, len));
+    return &decoded_;
+  }
+
+  static void* create_array(const redisReadTask* task, size_t elements) {
+    auto* sink = sink_of(task);
+    if (sink == nullptr) return fallback(task)->createArray(task, elements);
+    sink->on_array(task, elements);
+    return &decoded_;
+  }
+
+  static void* create_integer(const redisReadTask* task, long long val) {
+    auto* sink = sink_of(task);
+    if (sink == nullptr) return fallback(task)->createInteger(task, val);
+    sink->on_integer(task, val);
+    return &decoded_;
+  }
+
+  static void* create_double(const redisReadTask* task, double val, char* str,
+                             size_t len) {
+    auto* sink = sink_of(task);
+    if (sink == nullptr) {
+      return fallback(task)->createDouble(task, val, str, len);
+    }
+    sink->on_string(task, std::string_view(str, len));
+    return &decoded_;
+  }
+
+  static void* create_nil(const redisReadTask* task) {
+    auto* sink = sink_of(task);
+    if (sink == nullptr) return fallback(task)->createNil(task);
+    sink->on_nil(task);
+    return &decoded_;
+  }
+
+  static void* create_bool(const redisReadTask* task, int val) {
+    auto* sink = sink_of(task);
+    if (sink == nullptr) return fallback(task)->createBool(task, val);
+    sink->on_integer(task, val);
+    return &decoded_;
+  }
+
+  static void free_object(void* obj) {
+    if (obj != &decoded_) freeReplyObject(obj);
+  }
+
+  struct discard_sink final : reply_sink {
+    void on_array(const redisReadTask*, size_t) override {}
+    void on_string(const redisReadTask*, std::string_view) override {}
+    void on_integer(const redisReadTask*, long long) override {}
+    void on_nil(const redisReadTask*) override {}
+  };
+
+  static inline redisReply decoded_{REDIS_REPLY_NIL};
+  static inline discard_sink discard_;
+  static inline redisReplyObjectFunctions functions_{
+      create_string, create_array, create_integer, create_double,
+      create_nil,    create_bool,  free_object};
+
+  redisReader* reader_ = nullptr;
+  redisReplyObjectFunctions* default_fn_ = nullptr;
+  std::deque<reply_sink*> pending_;
+  std::function<void(reply_view)> push_handler_;
+};
+
+}  // namespace impl
+}  // namespace coro_redis
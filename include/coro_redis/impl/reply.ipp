@@ -0,0 +1,229 @@
+//
+// Copyright (c) 2020 Gu.Qiwei(gqwmail@qq.com)
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+//
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <hiredis/hiredis.h>
+
+namespace coro_redis {
+
+///
+/// @brief Read-only view of a redis reply, borrowed from hiredis.
+///
+/// Nothing is copied: strings are `std::string_view`s into the reply buffer.
+/// For `coro_connection` the view is valid until the awaiting coroutine
+/// suspends again, for `sync_connection` until the next command is sent on
+/// the same connection.
+///
+/// Example:
+/// @code{.cpp}
+/// auto r = co_await conn->command_argv<reply_view>("lrange", "list", 0, -1);
+/// for (auto elem : *r) hash(elem.str());
+/// @endcode
+///
+class reply_view {
+ public:
+  class iterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = reply_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = reply_view;
+
+    iterator() = default;
+    explicit iterator(redisReply* const* pos) : pos_(pos) {}
+
+    reply_view operator*() const { return reply_view(*pos_); }
+    reply_view operator[](difference_type n) const {
+      return reply_view(pos_[n]);
+    }
+    iterator& operator++() {
+      ++pos_;
+      return *this;
+    }
+    iterator operator++(int) { return iterator(pos_++); }
+    iterator& operator--() {
+      --pos_;
+      return *this;
+    }
+    iterator operator--(int) { return iterator(pos_--); }
+    iterator& operator+=(difference_type n) {
+      pos_ += n;
+      return *this;
+    }
+    iterator& operator-=(difference_type n) {
+      pos_ -= n;
+      return *this;
+    }
+    iterator operator+(difference_type n) const { return iterator(pos_ + n); }
+    friend iterator operator+(difference_type n, iterator it) {
+      return it + n;
+    }
+    iterator operator-(difference_type n) const { return iterator(pos_ - n); }
+    difference_type operator-(const iterator& other) const {
+      return pos_ - other.pos_;
+    }
+    auto operator<=>(const iterator&) const = default;
+
+   private:
+    redisReply* const* pos_ = nullptr;
+  };
+
+  reply_view() = default;
+  explicit reply_view(const redisReply* reply) : reply_(reply) {}
+
+  /// @brief hiredis reply type, `REDIS_REPLY_*`.
+  int type() const { return reply_ ? reply_->type : REDIS_REPLY_NIL; }
+  bool is_nil() const { return type() == REDIS_REPLY_NIL; }
+  bool is_array() const {
+    return type() == REDIS_REPLY_ARRAY || type() == REDIS_REPLY_SET ||
+           type() == REDIS_REPLY_MAP || type() == REDIS_REPLY_PUSH;
+  }
+  bool is_integer() const { return type() == REDIS_REPLY_INTEGER; }
+
+  /// @brief String payload of string, status, error or verbatim replies.
+  std::string_view str() const {
+    if (!reply_ || !reply_->str) return {};
+    return {reply_->str, reply_->len};
+  }
+
+  int64_t integer() const { return reply_ ? reply_->integer : 0; }
+
+  /// @brief Value of RESP3 double replies.
+  double dval() const { return reply_ ? reply_->dval : 0; }
+
+  /// @brief Value of RESP3 bool replies.
+  bool boolean() const { return reply_ && reply_->integer != 0; }
+
+  /// @brief RESP3 map replies hold keys and values alternately.
+  bool is_map() const { return type() == REDIS_REPLY_MAP; }
+
+  /// @brief Element count of aggregate replies, 0 otherwise.
+  size_t size() const { return reply_ ? reply_->elements : 0; }
+  bool empty() const { return size() == 0; }
+
+  reply_view operator[](size_t i) const {
+    return reply_view(reply_->element[i]);
+  }
+  iterator begin() const {
+    return iterator(reply_ ? reply_->element : nullptr);
+  }
+  iterator end() const { return begin() + size(); }
+
+  const redisReply* get() const { return reply_; }
+
+ private:
+  const redisReply* reply_ = nullptr;
+};
+
+///
+/// @brief Collection reply stored in one contiguous buffer plus an offset
+///   table, instead of one heap string per element.
+///
+/// Any command returning a list of strings accepts it as result type, e.g.
+/// `co_await conn->lrange<reply_arena>("list", 0, 100000)`. Elements are
+/// `std::string_view`s into the arena, nil elements are empty.
+///
+class reply_arena {
+ public:
+  using value_type = std::string_view;
+
+  class iterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::string_view;
+
+    iterator() = default;
+    iterator(const reply_arena* arena, size_t idx) : arena_(arena), idx_(idx) {}
+
+    std::string_view operator*() const { return (*arena_)[idx_]; }
+    std::string_view operator[](difference_type n) const {
+      return (*arena_)[idx_ + n];
+    }
+    iterator& operator++() {
+      ++idx_;
+      return *this;
+    }
+    iterator operator++(int) { return iterator(arena_, idx_++); }
+    iterator& operator--() {
+      --idx_;
+      return *this;
+    }
+    iterator operator--(int) { return iterator(arena_, idx_--); }
+    iterator& operator+=(difference_type n) {
+      idx_ += n;
+      return *this;
+    }
+    iterator& operator-=(difference_type n) {
+      idx_ -= n;
+      return *this;
+    }
+    iterator operator+(difference_type n) const {
+      return iterator(arena_, idx_ + n);
+    }
+    friend iterator operator+(difference_type n, iterator it) {
+      return it + n;
+    }
+    iterator operator-(difference_type n) const {
+      return iterator(arena_, idx_ - n);
+    }
+    difference_type operator-(const iterator& other) const {
+      return difference_type(idx_) - difference_type(other.idx_);
+    }
+    bool operator==(const iterator& other) const { return idx_ == other.idx_; }
+    auto operator<=>(const iterator& other) const { return idx_ <=> other.idx_; }
+
+   private:
+    const reply_arena* arena_ = nullptr;
+    size_t idx_ = 0;
+  };
+
+  /// @brief Reserve the offset table for n elements.
+  void reserve(size_t n) { offsets_.reserve(n + 1); }
+
+  /// @brief Reserve the byte buffer for n bytes of element data.
+  void reserve_bytes(size_t n) { data_.reserve(n); }
+
+  void push_back(std::string_view str) {
+    if (offsets_.empty()) offsets_.push_back(0);
+    data_.append(str);
+    offsets_.push_back(data_.size());
+  }
+
+  void clear() {
+    data_.clear();
+    offsets_.clear();
+  }
+
+  size_t size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+  bool empty() const { return size() == 0; }
+
+  std::string_view operator[](size_t i) const {
+    return {data_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]};
+  }
+
+  iterator begin() const { return iterator(this, 0); }
+  iterator end() const { return iterator(this, size()); }
+
+  /// @brief All element bytes, back to back.
+  std::string_view bytes() const { return data_; }
+
+ private:
+  std::string data_;
+  std::vector<size_t> offsets_;  // element i is [offsets_[i], offsets_[i + 1])
+};
+
+}  // namespace coro_redis
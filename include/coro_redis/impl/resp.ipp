@@ -0,0 +1,318 @@
+//
+// Copyright (c) 2020 Gu.Qiwei(gqwmail@qq.com)
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+//
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <forward_list>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <coro_redis/impl/config.ipp>
+
+namespace coro_redis {
+namespace impl {
+
+///
+/// @brief String literal usable as template parameter, e.g. command names.
+///
+template <size_t N>
+struct fixed_string {
+  constexpr fixed_string(const char (&str)[N]) { std::copy_n(str, N, data); }
+  constexpr size_t size() const { return N - 1; }
+  constexpr std::string_view view() const { return {data, N - 1}; }
+
+  char data[N]{};
+};
+
+/// @brief Number of decimal digits of n.
+constexpr size_t decimal_digits(size_t n) {
+  size_t d = 1;
+  for (; n >= 10; n /= 10) ++d;
+  return d;
+}
+
+///
+/// @brief Descriptor of a command with fixed name and argument count.
+///
+/// The RESP array header and the command name bulk string, e.g.
+/// "*2\r\n$3\r\nget\r\n", are built at compile time, only the variable
+/// arguments are serialized when the command is sent.
+///
+template <fixed_string NAME, size_t ARITY>
+struct command_spec {
+  static constexpr std::string_view name() { return NAME.view(); }
+  static constexpr std::string_view prefix() {
+    return {header_.data(), header_.size()};
+  }
+
+ private:
+  static constexpr size_t header_size = 1 + decimal_digits(ARITY + 1) + 2 + 1 +
+                                        decimal_digits(NAME.size()) + 2 + NAME.size() +
+                                        2;
+
+  static constexpr std::array<char, header_size> header_ = [] {
+    std::array<char, header_size> buf{};
+    char* out = buf.data();
+    auto put_num = [&](char type, size_t n) {
+      *out++ = type;
+      size_t d = decimal_digits(n);
+      for (size_t i = d; i > 0; --i, n /= 10) out[i - 1] = char('0' + n % 10);
+      out += d;
+      *out++ = '\r';
+      *out++ = '\n';
+    };
+    put_num('*', ARITY + 1);
+    put_num('$', NAME.size());
+    for (size_t i = 0; i < NAME.size(); ++i) *out++ = NAME.data[i];
+    *out++ = '\r';
+    *out++ = '\n';
+    return buf;
+  }();
+};
+
+///
+/// @brief One argument of redis command, a string or a number which is
+///   formatted when the command is written.
+///
+struct command_arg {
+  enum class kind : uint8_t { string, integer, unsigned_integer, floating };
+
+  kind type = kind::string;
+  std::string_view str;
+  union {
+    int64_t i;
+    uint64_t u;
+    double d;
+  } num{};
+};
+
+///
+/// @brief Argument vector of one redis command.
+///
+/// Every argument is sent to redis as a RESP bulk string, so keys and values
+/// may contain spaces, quotes or NUL bytes. Temporary `std::string`s are
+/// moved in and owned, other string arguments are referenced, not copied:
+/// they must stay alive until the command is written, i.e. until the awaiter
+/// is `co_await`ed.
+///
+class command_args {
+ public:
+  command_args() = default;
+  command_args(command_args&&) = default;
+  command_args& operator=(command_args&&) = default;
+  // owned arguments would still be referenced by the copy
+  command_args(const command_args&) = delete;
+  command_args& operator=(const command_args&) = delete;
+
+  template <typename... Args>
+  explicit command_args(std::string_view name, Args&&... args) {
+    reserve(sizeof...(Args) + 1);
+    append(name);
+    (append(std::forward<Args>(args)), ...);
+  }
+
+  template <fixed_string NAME, size_t ARITY, typename... Args>
+  explicit command_args(command_spec<NAME, ARITY> spec, Args&&... args)
+      : name_(spec.name()), prefix_(spec.prefix()), prefix_args_(ARITY) {
+    static_assert(sizeof...(Args) == ARITY, "argument count mismatch");
+    reserve(sizeof...(Args));
+    (append(std::forward<Args>(args)), ...);
+  }
+
+  /// @brief Build arguments from a whole command line, e.g. "set key val",
+  ///   arguments are separated by whitespace.
+  static command_args split(std::string_view line) {
+    command_args args;
+    size_t pos = 0;
+    while (pos < line.size()) {
+      pos = line.find_first_not_of(" \t\r\n", pos);
+      if (pos == std::string_view::npos) break;
+      auto end = line.find_first_of(" \t\r\n", pos);
+      if (end == std::string_view::npos) end = line.size();
+      args.append(line.substr(pos, end - pos));
+      pos = end;
+    }
+    return args;
+  }
+
+  command_args& append(std::string_view str) {
+    command_arg arg;
+    arg.str = str;
+    return push(arg);
+  }
+
+  /// @brief A temporary string is kept until the arguments are destroyed.
+  template <typename S>
+    requires std::is_same_v<S, std::string>
+  command_args& append(S&& str) {
+    owned_.push_front(std::move(str));
+    return append(std::string_view(owned_.front()));
+  }
+
+  template <typename T>
+    requires std::is_arithmetic_v<std::decay_t<T>>
+  command_args& append(T val) {
+    command_arg arg;
+    if constexpr (std::is_floating_point_v<T>) {
+      arg.type = command_arg::kind::floating;
+      arg.num.d = val;
+    } else if constexpr (std::is_signed_v<T>) {
+      arg.type = command_arg::kind::integer;
+      arg.num.i = val;
+    } else {
+      arg.type = command_arg::kind::unsigned_integer;
+      arg.num.u = val;
+    }
+    return push(arg);
+  }
+
+  /// @brief Append every element of a sized range, pairs are appended as
+  ///   two arguments, e.g. the key and the value of a map entry.
+  template <typename R>
+  command_args& append_range(R&& range) {
+    constexpr bool is_pair = requires(std::ranges::range_reference_t<R> kv) {
+      kv.first;
+      kv.second;
+    };
+    auto n = static_cast<size_t>(std::ranges::size(range));
+    reserve(size_ + (is_pair ? 2 * n : n));
+    for (auto&& elem : range) {
+      if constexpr (is_pair) {
+        append(elem.first).append(elem.second);
+      } else {
+        append(elem);
+      }
+    }
+    return *this;
+  }
+
+  void reserve(size_t n) {
+    if (n > kInlineArgs) heap_.reserve(n);
+  }
+
+  bool empty() const { return size_ == 0 && name_.empty(); }
+  size_t size() const { return size_ + (name_.empty() ? 0 : 1); }
+
+  /// @brief Command name of a compile-time command, empty otherwise, the
+  ///   name is not part of [begin(), end()).
+  std::string_view name() const { return name_; }
+
+  /// @brief Precomputed RESP header of a compile-time command, empty if
+  ///   arguments were appended past its arity.
+  std::string_view prefix() const {
+    return size_ == prefix_args_ ? prefix_ : std::string_view();
+  }
+
+  const command_arg* begin() const {
+    return heap_.empty() ? inline_ : heap_.data();
+  }
+  const command_arg* end() const { return begin() + size_; }
+
+ private:
+  static constexpr size_t kInlineArgs = 8;
+
+  command_args& push(const command_arg& arg) {
+    if (heap_.empty() && size_ < kInlineArgs) {
+      inline_[size_++] = arg;
+      return *this;
+    }
+    if (heap_.empty()) heap_.assign(inline_, inline_ + size_);
+    heap_.push_back(arg);
+    ++size_;
+    return *this;
+  }
+
+  std::string_view name_;
+  std::string_view prefix_;
+  size_t prefix_args_ = 0;
+  command_arg inline_[kInlineArgs];
+  size_t size_ = 0;
+  std::vector<command_arg> heap_;  // used when arguments exceed inline slots
+  std::forward_list<std::string> owned_;  // nodes stay put when moved
+};
+
+///
+/// @brief RESP serializer writing commands into a reusable growable buffer.
+///
+/// A connection owns one writer and rewinds it before every command, hiredis
+/// copies the bytes into its output buffer, so in steady state no memory is
+/// allocated for formatting.
+///
+class resp_writer {
+ public:
+  void clear() { buf_.clear(); }
+  void reserve(size_t n) { buf_.reserve(buf_.size() + n); }
+  const char* data() const { return buf_.data(); }
+  size_t size() const { return buf_.size(); }
+
+  void write_array(size_t n) { write_header('*', n); }
+
+  void write(std::string_view str) {
+    write_header('$', str.size());
+    buf_.append(str).append("\r\n", 2);
+  }
+
+  template <typename T>
+    requires std::is_integral_v<T>
+  void write(T val) {
+    char tmp[24];
+    auto [end, ec] = std::to_chars(tmp, tmp + sizeof(tmp), val);
+    write(std::string_view(tmp, end - tmp));
+  }
+
+  /// Shortest representation which parses back to the same value, e.g.
+  /// scores keep full precision and 1.5 is sent as "1.5".
+  void write(double val) {
+    char tmp[32];
+    auto [end, ec] = std::to_chars(tmp, tmp + sizeof(tmp), val);
+    write(std::string_view(tmp, end - tmp));
+  }
+
+  void write(const command_arg& arg) {
+    switch (arg.type) {
+      case command_arg::kind::string: write(arg.str); break;
+      case command_arg::kind::integer: write(arg.num.i); break;
+      case command_arg::kind::unsigned_integer: write(arg.num.u); break;
+      case command_arg::kind::floating: write(arg.num.d); break;
+    }
+  }
+
+  void write(const command_args& args) {
+    size_t len = 16 + args.name().size();
+    for (const auto& arg : args) len += arg.str.size() + 32;
+    reserve(len);
+    if (auto prefix = args.prefix(); !prefix.empty()) {
+      buf_.append(prefix);
+    } else {
+      write_array(args.size());
+      if (!args.name().empty()) write(args.name());
+    }
+    for (const auto& arg : args) write(arg);
+  }
+
+ private:
+  void write_header(char type, size_t n) {
+    char tmp[24];
+    tmp[0] = type;
+    auto [end, ec] = std::to_chars(tmp + 1, tmp + sizeof(tmp) - 2, n);
+    *end++ = '\r';
+    *end++ = '\n';
+    buf_.append(tmp, end);
+  }
+
+  std::string buf_;
+};
+
+}  // namespace impl
+}  // namespace coro_redis
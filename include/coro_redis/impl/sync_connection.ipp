@@ -7,16 +7,35 @@
 //
 #pragma once
 
+#include <charconv>
+#include <functional>
+#include <memory>
 #include <optional>
-#include <fmt/format.h>
 #include <hiredis/hiredis.h>
 #include <coro_redis/impl/config.ipp>
+#include <coro_redis/impl/reader.ipp>
+#include <coro_redis/impl/reply.ipp>
+#include <coro_redis/impl/resp.ipp>
 
 namespace coro_redis {
 namespace impl {
 class sync_connection_impl {
  public:
-  sync_connection_impl(redisContext* ctx) : redis_ctx_(ctx) {}
+  sync_connection_impl(redisContext* ctx,
+                       RedisProtocol protocol = RedisProtocol::RESP2)
+      : redis_ctx_(ctx), protocol_(protocol) {
+    if (ctx == nullptr) return;
+    reader_.attach(ctx->reader);
+    if (protocol == RedisProtocol::RESP3) {
+      auto ret = command<reply_view>(command_args("hello", 3));
+      if (!ret || !ret->is_map()) {
+        LOG_ERROR("switch to RESP3 failed, server may be older than 6.0");
+        protocol_ = RedisProtocol::RESP2;
+      }
+    }
+  }
+
+  RedisProtocol protocol() const { return protocol_; }
 
   template <typename RET>
   static std::optional<RET> deal_redis_reply(redisReply* reply) {
@@ -24,18 +43,31 @@ class sync_connection_impl {
     ASSERT_RETURN(reply->type != REDIS_REPLY_NIL, std::nullopt,
                   "reply type is null");
 
+    if constexpr (std::is_same_v<RET, reply_view>) {
+      ASSERT_RETURN(reply->type != REDIS_REPLY_ERROR, std::nullopt,
+                    "redis reply error, {}",
+                    std::string(reply->str, reply->len));
+      return reply_view(reply);
+    }
     if constexpr (std::is_same_v<RET, std::string>) {
+      // RESP3 sends scores as doubles and some texts as verbatim strings
       ASSERT_RETURN(reply->type == REDIS_REPLY_STRING ||
-                        reply->type == REDIS_REPLY_STATUS,
+                        reply->type == REDIS_REPLY_STATUS ||
+                        reply->type == REDIS_REPLY_VERB ||
+                        reply->type == REDIS_REPLY_DOUBLE ||
+                        reply->type == REDIS_REPLY_BIGNUM,
                     std::nullopt, "redis response type not match, {}, {}",
                     reply->type, std::string(reply->str, reply->len));
       return std::string(reply->str, reply->len);
     }
     if constexpr (std::is_same_v<RET, std::vector<std::string>>) {
-      ASSERT_RETURN(reply->type == REDIS_REPLY_ARRAY, std::nullopt,
-                    "redis response type not match, {}, {}", reply->type,
-                    std::string(reply->str, reply->len));
+      ASSERT_RETURN(reply->type == REDIS_REPLY_ARRAY ||
+                        reply->type == REDIS_REPLY_SET ||
+                        reply->type == REDIS_REPLY_MAP,
+                    std::nullopt, "redis response type not match, {}, {}",
+                    reply->type, std::string(reply->str, reply->len));
       std::vector<std::string> resp;
+      resp.reserve(reply->elements);
       for (size_t i = 0; i < reply->elements; ++i) {
         if (reply->element[i]->type != REDIS_REPLY_STRING) {
           resp.push_back("");
@@ -51,15 +83,21 @@ class sync_connection_impl {
                     std::string(reply->str, reply->len));
       return reply->integer;
     } else if constexpr (std::is_same_v<RET, double>) {
-      ASSERT_RETURN(reply->type == REDIS_REPLY_DOUBLE, std::nullopt,
+      if (reply->type == REDIS_REPLY_DOUBLE) return reply->dval;
+      ASSERT_RETURN(reply->type == REDIS_REPLY_STRING, std::nullopt,
                     "redis response type not match, {}, {}", reply->type,
                     std::string(reply->str, reply->len));
-      return stod(std::string(reply->str, reply->len));
-    } else if constexpr (std::is_same_v<RET, bool>) {
-      ASSERT_RETURN(reply->type == REDIS_REPLY_BOOL, std::nullopt,
-                    "redis response type not match, {}, {}", reply->type,
+      double val = 0;
+      auto [ptr, ec] = std::from_chars(reply->str, reply->str + reply->len, val);
+      ASSERT_RETURN(ec == std::errc(), std::nullopt, "parse double failed, {}",
                     std::string(reply->str, reply->len));
-      return stol(std::string(reply->str, reply->len));
+      return val;
+    } else if constexpr (std::is_same_v<RET, bool>) {
+      ASSERT_RETURN(reply->type == REDIS_REPLY_BOOL ||
+                        reply->type == REDIS_REPLY_INTEGER,
+                    std::nullopt, "redis response type not match, {}",
+                    reply->type);
+      return reply->integer != 0;
     } else if constexpr (std::is_void_v<RET>) {
       return std::nullopt;
     }
@@ -67,189 +105,249 @@ class sync_connection_impl {
   }
 
   /// @brief Send redis command.
-  /// @param cmd Redis command.
+  /// @param args Redis command arguments.
+  /// @return Redis return.
+  template <typename RET = std::string>
+  std::optional<RET> command(const command_args& args) const {
+    if (!append(args)) return std::nullopt;
+    return read_result<RET>();
+  }
+
+  template <typename RET = std::string>
+  std::optional<RET> command(
+      const command_args& args,
+      std::function<std::optional<RET>(redisReply*)> op) const {
+    if (!append(args)) return std::nullopt;
+    auto* reply = read_reply();
+    ASSERT_RETURN(reply != nullptr, std::nullopt, "reply is null");
+    auto ret = op(reply);
+    freeReplyObject(reply);
+    return ret;
+  }
+
+  /// @brief Send `count` commands encoded back to back in `cmds` with one
+  ///   write, then read all their replies.
+  /// @return One result per command, in order.
+  template <typename RET = std::string>
+  std::vector<std::optional<RET>> command_batch(std::string_view cmds,
+                                                size_t count) const {
+    static_assert(!std::is_same_v<RET, reply_view>,
+                  "reply_view is only valid until the next reply");
+    std::vector<std::optional<RET>> rets;
+    rets.reserve(count);
+    if (count == 0) return rets;
+    last_reply_.reset();
+    if (redisAppendFormattedCommand(redis_ctx_, cmds.data(), cmds.size()) !=
+        REDIS_OK) {
+      LOG_ERROR("append redis command failed, {}", redis_ctx_->errstr);
+      rets.resize(count);
+      return rets;
+    }
+    while (rets.size() < count && redis_ctx_->err == 0) {
+      rets.push_back(read_result<RET>());
+    }
+    rets.resize(count);  // the rest is lost with the connection
+    return rets;
+  }
+
+  /// @brief Send redis command.
+  /// @param cmd Redis command line, arguments are separated by whitespace.
   /// @return Redis return.
   template <typename RET = std::string>
   std::optional<RET> command(std::string_view cmd) const {
-    return sync_connection_impl::deal_redis_reply<RET>(
-        (redisReply*)redisCommand(redis_ctx_, std::string(cmd).c_str()));
+    return command<RET>(command_args::split(cmd));
   }
 
   template <typename RET = std::string>
   std::optional<RET> command(
       std::string_view cmd,
       std::function<std::optional<RET>(redisReply*)> op) const {
-    return op((redisReply*)redisCommand(redis_ctx_, std::string(cmd).c_str()));
+    return command<RET>(command_args::split(cmd), std::move(op));
+  }
+
+  /// @brief Send redis command built from argument list.
+  /// @param name Command name.
+  /// @param args Command arguments, each one is sent as a bulk string.
+  /// @return Redis return.
+  template <typename RET = std::string, typename... Args>
+  std::optional<RET> command_argv(std::string_view name,
+                                  Args&&... args) const {
+    return command<RET>(command_args(name, std::forward<Args>(args)...));
+  }
+
+  /// @brief Send redis command with compile-time name, its RESP header is
+  ///   precomputed and only the arguments are serialized.
+  template <typename RET = std::string, fixed_string NAME, typename... Args>
+  std::optional<RET> command_argv(Args&&... args) const {
+    return command<RET>(command_args(command_spec<NAME, sizeof...(Args)>{},
+                                     std::forward<Args>(args)...));
   }
 
   inline std::optional<scan_ret_t> scan(uint64_t cursor,
                                         std::string_view pattern,
                                         uint64_t count) {
-    std::string cmd("scan");
-    cmd.append(" ").append(std::to_string(cursor));
+    command_args args("scan", cursor);
     if (!pattern.empty()) {
-      cmd.append(" MATCH ").append(pattern);
+      args.append("MATCH").append(pattern);
     }
     if (count > 0) {
-      cmd.append(" COUNT ").append(std::to_string(count));
+      args.append("COUNT").append(count);
     }
-    return send_scan_cmd(cmd);
+    return send_scan_cmd(args);
   }
 
   std::optional<scan_ret_t> hscan(std::string_view key, uint64_t cursor,
                                   std::string_view pattern, uint64_t count) {
-    std::string cmd("hscan");
-    cmd.append(" ").append(key);
-    cmd.append(" ").append(std::to_string(cursor));
-    if (!pattern.empty()) {
-      cmd.append(" MATCH ").append(pattern);
-    }
-    if (count > 0) {
-      cmd.append(" COUNT ").append(std::to_string(count));
-    }
-    return send_scan_cmd(cmd);
+    return send_scan_cmd(scan_args("hscan", key, cursor, pattern, count));
   }
 
   std::optional<scan_ret_t> sscan(std::string_view key, uint64_t cursor,
                                   std::string_view pattern, uint64_t count) {
-    std::string cmd("sscan");
-    cmd.append(" ").append(key);
-    cmd.append(" ").append(std::to_string(cursor));
-    if (!pattern.empty()) {
-      cmd.append(" MATCH ").append(pattern);
-    }
-    if (count > 0) {
-      cmd.append(" COUNT ").append(std::to_string(count));
-    }
-    return send_scan_cmd(cmd);
+    return send_scan_cmd(scan_args("sscan", key, cursor, pattern, count));
   }
 
   std::optional<scan_ret_t> zscan(std::string_view key, uint64_t cursor,
                                   std::string_view pattern, uint64_t count) {
-    std::string cmd("zscan");
-    cmd.append(" ").append(key);
-    cmd.append(" ").append(std::to_string(cursor));
+    return send_scan_cmd(scan_args("zscan", key, cursor, pattern, count));
+  }
+
+  static command_args scan_args(std::string_view name, std::string_view key,
+                                uint64_t cursor, std::string_view pattern,
+                                uint64_t count) {
+    command_args args(name, key, cursor);
     if (!pattern.empty()) {
-      cmd.append(" MATCH ").append(pattern);
+      args.append("MATCH").append(pattern);
     }
     if (count > 0) {
-      cmd.append(" COUNT ").append(std::to_string(count));
+      args.append("COUNT").append(count);
     }
-    return send_scan_cmd(cmd);
-  }
-
-  std::optional<scan_ret_t> send_scan_cmd(std::string_view cmd) {
-    return command<scan_ret_t>(
-        cmd, [](redisReply* reply) -> std::optional<scan_ret_t> {
-          scan_ret_t ret;
-          ASSERT_RETURN(reply->type == REDIS_REPLY_ARRAY, ret,
-                        "scan result type not match, {}", reply->type);
-          ASSERT_RETURN(reply->elements == 2, ret,
-                        "scan result element count not 2, {}", reply->elements);
-          auto elem_0 = reply->element[0];
-          ASSERT_RETURN(elem_0->type == REDIS_REPLY_STRING, ret,
-                        "scan element[0] type not string, {}", elem_0->type);
-          ASSERT_RETURN(elem_0->len > 0, ret, "scan element[0] is null, {}",
-                        elem_0->len);
-          ret.first = std::stoll(std::string(elem_0->str, elem_0->len));
-          auto elem_1 = reply->element[1];
-          ASSERT_RETURN(elem_1->type == REDIS_REPLY_ARRAY, ret,
-                        "scan element[1] type not match, {}", elem_1->type);
-          for (size_t i = 0; i < elem_1->elements; ++i) {
-            if (elem_1->element[i]->type != REDIS_REPLY_STRING) {
-              ret.second.push_back("");
-            } else {
-              ret.second.push_back(std::string(elem_1->element[i]->str,
-                                               elem_1->element[i]->len));
-            }
-          }
-          return ret;
-        });
+    return args;
   }
-  template <RedisSetValueType T>
-  std::optional<std::string> set(std::string_view key, T val, uint64_t ttl,
-                                 RedisTTLType ttl_type, UpdateType type) {
-    std::string cmd(fmt::format("set {} {}", key, val));
+
+  std::optional<scan_ret_t> send_scan_cmd(const command_args& args) {
+    return command<scan_ret_t>(args);
+  }
+
+  static void append_ttl(command_args& args, uint64_t ttl,
+                         RedisTTLType ttl_type) {
     if (ttl > 0 && ttl_type != RedisTTLType::KEEPTTL) {
       switch (ttl_type) {
-        case RedisTTLType::EX:
-          cmd.append(" EX ");
-          break;
-        case RedisTTLType::PX:
-          cmd.append(" PX ");
-          break;
-        case RedisTTLType::EXAT:
-          cmd.append(" EXAT ");
-          break;
-        case RedisTTLType::PXAT:
-          cmd.append(" PXAT ");
-          break;
+        case RedisTTLType::EX: args.append("EX"); break;
+        case RedisTTLType::PX: args.append("PX"); break;
+        case RedisTTLType::EXAT: args.append("EXAT"); break;
+        case RedisTTLType::PXAT: args.append("PXAT"); break;
+        case RedisTTLType::KEEPTTL: break;
       }
-      cmd.append(std::to_string(ttl));
+      args.append(ttl);
     }
     if (ttl_type == RedisTTLType::KEEPTTL) {
-      cmd.append(" KEEPTTL ");
+      args.append("KEEPTTL");
     }
+  }
+
+  static void append_update_type(command_args& args, UpdateType type) {
     switch (type) {
-      case UpdateType::EXIST:
-        cmd.append(" XX ");
-        break;
-      case UpdateType::NOT_EXIST:
-        cmd.append(" NX ");
-        break;
+      case UpdateType::EXIST: args.append("XX"); break;
+      case UpdateType::NOT_EXIST: args.append("NX"); break;
+      case UpdateType::LESS_THAN: args.append("LT"); break;
+      case UpdateType::GREATE_THAN: args.append("GT"); break;
+      case UpdateType::CHANGED: args.append("CH"); break;
+      case UpdateType::INCR: args.append("INCR"); break;
+      case UpdateType::ALWAYS: break;
     }
-    return command<std::string>(std::move(cmd));
   }
 
-  std::optional<uint64_t> hset(
+  // A temporary string value is moved into the arguments.
+  template <typename T>
+    requires RedisSetValueType<std::remove_cvref_t<T>>
+  static command_args set_args(std::string_view key, T&& val,
+                               uint64_t ttl, RedisTTLType ttl_type,
+                               UpdateType type) {
+    command_args args("set", key, std::forward<T>(val));
+    append_ttl(args, ttl, ttl_type);
+    switch (type) {
+      case UpdateType::EXIST: args.append("XX"); break;
+      case UpdateType::NOT_EXIST: args.append("NX"); break;
+      default: break;
+    }
+    return args;
+  }
+
+  static command_args hset_args(
       std::string_view key,
       const std::vector<std::pair<std::string_view, std::string_view>>& kvs) {
-    std::string cmd("hset");
-    cmd.append(" ").append(key);
+    command_args args("hset", key);
+    for (const auto& kv : kvs) {
+      args.append(kv.first).append(kv.second);
+    }
+    return args;
+  }
+
+  static command_args zadd_args(
+      std::string_view key,
+      const std::vector<std::pair<std::string_view, double>>& kvs,
+      UpdateType type) {
+    command_args args("zadd", key);
+    append_update_type(args, type);
+    for (const auto& kv : kvs) {
+      args.append(kv.second).append(kv.first);
+    }
+    return args;
+  }
+
+  static command_args zunionstore_args(
+      std::string_view destination,
+      std::initializer_list<std::string_view> keys,
+      std::string_view aggregate) {
+    command_args args("zunionstore", destination, keys.size());
+    for (const auto& key : keys) {
+      args.append(key);
+    }
+    args.append("AGGREGATE").append(aggregate);
+    return args;
+  }
+
+  static command_args zunionstore_args(
+      std::string_view destination,
+      const std::vector<std::pair<std::string_view, double>>& kvs,
+      std::string_view aggregate) {
+    command_args args("zunionstore", destination, kvs.size());
     for (const auto& kv : kvs) {
-      cmd.append(" ").append(kv.first);
-      cmd.append(" ").append(kv.second);
+      args.append(kv.first);
     }
-    return command<uint64_t>(std::move(cmd));
+    args.append("WEIGHTS");
+    for (const auto& kv : kvs) {
+      args.append(kv.second);
+    }
+    args.append("AGGREGATE").append(aggregate);
+    return args;
+  }
+
+  template <RedisSetValueType T>
+  std::optional<std::string> set(std::string_view key, const T& val,
+                                 uint64_t ttl,
+                                 RedisTTLType ttl_type, UpdateType type) {
+    return command<std::string>(set_args(key, val, ttl, ttl_type, type));
+  }
+
+  std::optional<uint64_t> hset(
+      std::string_view key,
+      const std::vector<std::pair<std::string_view, std::string_view>>& kvs) {
+    return command<uint64_t>(hset_args(key, kvs));
   }
 
   std::optional<uint64_t> zadd(std::string_view key, std::string_view member,
                                double score, UpdateType type) {
-    std::string cmd("zadd");
-    cmd.append(" ").append(key);
-    switch (type) {
-      case UpdateType::EXIST: cmd.append(" XX "); break;
-      case UpdateType::NOT_EXIST: cmd.append(" NX "); break;
-      case UpdateType::LESS_THAN: cmd.append(" LT "); break;
-      case UpdateType::GREATE_THAN: cmd.append(" GT "); break;
-      case UpdateType::CHANGED: cmd.append(" CH "); break;
-      case UpdateType::INCR: cmd.append(" INCR "); break;
-      default: break;
-    }
-    cmd.append(" ").append(std::to_string(score));
-    cmd.append(" ").append(member);
-    return command<uint64_t>(std::move(cmd));
+    command_args args("zadd", key);
+    append_update_type(args, type);
+    args.append(score).append(member);
+    return command<uint64_t>(args);
   }
 
   std::optional<uint64_t> zadd(
       std::string_view key,
       std::vector<std::pair<std::string_view, double>> kvs, UpdateType type) {
-    std::string cmd("zadd");
-    cmd.append(" ").append(key);
-    switch (type) {
-      case UpdateType::EXIST: cmd.append(" XX "); break;
-      case UpdateType::NOT_EXIST: cmd.append(" NX "); break;
-      case UpdateType::LESS_THAN:  cmd.append(" LT "); break;
-      case UpdateType::GREATE_THAN: cmd.append(" GT "); break;
-      case UpdateType::CHANGED: cmd.append(" CH ");  break;
-      case UpdateType::INCR: cmd.append(" INCR "); break;
-      default: break;
-    }
-    for (const auto& kv : kvs) {
-      cmd.append(" ").append(std::to_string(kv.second));
-      cmd.append(" ").append(kv.first);
-    }
-    return command<uint64_t>(std::move(cmd));
+    return command<uint64_t>(zadd_args(key, kvs, type));
   }
 
   std::optional<uint64_t> zunionstore(
@@ -257,15 +355,7 @@ class sync_connection_impl {
       std::initializer_list<std::string_view> keys,
       std::string_view aggregate) {
     if (keys.size() == 0) return {};
-
-    std::string cmd("zadd");
-    cmd.append(" ").append(destination);
-    cmd.append(" ").append(std::to_string(keys.size()));
-    for (const auto& key : keys) {
-      cmd.append(" ").append(key);
-    }
-    cmd.append(" ").append(aggregate);
-    return command<uint64_t>(std::move(cmd));
+    return command<uint64_t>(zunionstore_args(destination, keys, aggregate));
   }
 
   std::optional<uint64_t> zunionstore(
@@ -273,23 +363,112 @@ class sync_connection_impl {
       std::vector<std::pair<std::string_view, double>> kvs,
       std::string_view aggregate) {
     if (kvs.size() == 0) return {};
+    return command<uint64_t>(zunionstore_args(destination, kvs, aggregate));
+  }
 
-    std::string cmd("zadd");
-    cmd.append(" ").append(destination);
-    cmd.append(" ").append(std::to_string(kvs.size()));
-    for (const auto& kv : kvs) {
-      cmd.append(" ").append(kv.first);
-    }
-    cmd.append(" WEIGHTS ");
-    for (const auto& kv : kvs) {
-      cmd.append(" ").append(std::to_string(kv.second));
+ private:
+  struct reply_deleter {
+    void operator()(redisReply* reply) const { freeReplyObject(reply); }
+  };
+
+  bool append(const command_args& args) const {
+    ASSERT_RETURN(!args.empty(), false, "redis command is empty");
+    last_reply_.reset();
+    writer_.clear();
+    writer_.write(args);
+    ASSERT_RETURN(redisAppendFormattedCommand(redis_ctx_, writer_.data(),
+                                              writer_.size()) == REDIS_OK,
+                  false, "append redis command failed, {}",
+                  redis_ctx_->errstr);
+    return true;
+  }
+
+  redisReply* read_reply(reply_sink* sink = nullptr) const {
+    reader_.push(sink);
+    void* reply = nullptr;
+    auto ret = redisGetReply(redis_ctx_, &reply);
+    reader_.pop();
+    ASSERT_RETURN(ret == REDIS_OK, nullptr, "get redis reply failed, {}",
+                  redis_ctx_->errstr);
+    return (redisReply*)reply;
+  }
+
+  template <typename RET>
+  std::optional<RET> read_result() const {
+    if constexpr (StreamedReply<RET>) {
+      // decoded by the reader straight into the container
+      reply_sink_t<RET> sink;
+      ASSERT_RETURN(read_reply(&sink) != nullptr, std::nullopt,
+                    "reply is null");
+      return sink.result();
+    } else {
+      auto* reply = read_reply();
+      auto ret = sync_connection_impl::deal_redis_reply<RET>(reply);
+      if constexpr (std::is_same_v<RET, reply_view>) {
+        last_reply_.reset(reply);  // borrowed by the view until next command
+      } else if (reply) {
+        freeReplyObject(reply);
+      }
+      return ret;
     }
-    cmd.append(" ").append(aggregate);
-    return command<uint64_t>(std::move(cmd));
   }
 
- private:
   redisContext* redis_ctx_ = nullptr;  // redis contex
+  RedisProtocol protocol_ = RedisProtocol::RESP2;
+  mutable resp_writer writer_;         // reusable command buffer
+  mutable reply_reader reader_;        // decodes replies of queued sinks
+  mutable std::unique_ptr<redisReply, reply_deleter> last_reply_;
+};
+
+///
+/// @brief Commands sent to the server with one write, their replies are read
+///   in one go, see `sync_connection::batch`.
+///
+/// Arguments are encoded when added, so they need not outlive the call.
+/// The batch buffers every command until `exec`, very large imports should
+/// call `exec` every few thousand commands.
+///
+class sync_batch {
+ public:
+  explicit sync_batch(const sync_connection_impl* conn) : conn_(conn) {}
+
+  /// @brief Queue one command.
+  template <typename... Args>
+  sync_batch& add(std::string_view name, Args&&... args) {
+    return add(command_args(name, std::forward<Args>(args)...));
+  }
+
+  sync_batch& add(const command_args& args) {
+    ASSERT_RETURN(!args.empty(), *this, "redis command is empty");
+    writer_.write(args);
+    ++count_;
+    return *this;
+  }
+
+  size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+
+  void clear() {
+    writer_.clear();
+    count_ = 0;
+  }
+
+  /// @brief Send the queued commands and read their replies, all decoded
+  ///   as `RET`. The batch is empty afterwards.
+  template <typename RET = std::string>
+  std::vector<std::optional<RET>> exec() {
+    auto rets = conn_->command_batch<RET>(
+        std::string_view(writer_.data(), writer_.size()), count_);
+    clear();
+    return rets;
+  }
+
+ private:
+  const sync_connection_impl* conn_ = nullptr;
+  resp_writer writer_;
+  size_t count_ = 0;
 };
 }  // namespace impl
-}  // namespace coro_redis
\ No newline at end of file
+
+using sync_batch = impl::sync_batch;
+}  // namespace coro_redis
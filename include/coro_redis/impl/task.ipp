@@ -8,69 +8,162 @@
 #pragma once
 
 #include <any>
+#include <exception>
 #include <functional>
 #include <optional>
+#include <stdexcept>
 #include <coroutine>
+#include <type_traits>
+#include <utility>
 #include <coro_redis/impl/config.ipp>
+#include <coro_redis/impl/frame_pool.ipp>
 
 namespace coro_redis {
 
 template<typename TASK_RET> class task_promise;
 
-struct nothing { };
-
-template <typename T>
-struct void_to_nothing
-{
-    using type = T;
-};
-
-template <>
-struct void_to_nothing<void>
-{
-    using type = nothing;
-};
-
+///
+/// @brief Lazily started coroutine, it runs when awaited or detached.
+///
+/// Awaiting a task starts it and suspends the caller, when the task finishes
+/// the caller is resumed by symmetric transfer, so nested tasks neither grow
+/// the stack nor go through the event loop. An exception thrown by the task
+/// is rethrown by `co_await`.
+///
+/// Example:
+/// @code{.cpp}
+/// task<uint64_t> count_visit(std::shared_ptr<coro_connection> conn) {
+///     auto val = co_await conn->incr("visits");
+///     co_return val.value_or(0);
+/// }
+///
+/// task<void> handle(std::shared_ptr<coro_connection> conn) {
+///     auto visits = co_await count_visit(conn);
+///     LOG_INFO("visits {}", visits);
+/// }
+///
+/// handle(conn).detach();  // top level, nobody awaits it
+/// @endcode
+///
 template<typename TASK_RET>
-class task {
+class [[nodiscard("co_await or detach() the task, otherwise it never runs")]] task {
 public:
     using promise_type = task_promise<TASK_RET>;
     using value_type = TASK_RET;
-    friend class task_promise<TASK_RET>;
+    using handle_type = coro::coroutine_handle<promise_type>;
 
 public:
-    task(coro::coroutine_handle<> h) {
-        h_coro_ = h;
+    task() = default;
+
+    explicit task(handle_type h) : h_coro_(h) {}
+
+    task(task&& other) noexcept : h_coro_(std::exchange(other.h_coro_, {})) {}
+
+    task& operator=(task&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            h_coro_ = std::exchange(other.h_coro_, {});
+        }
+        return *this;
     }
 
-    ~task() {  }
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+
+    ~task() { destroy(); }
 
     auto& handler() { return h_coro_; }
 
-    const auto& return_value() {
-        return ret_value_;
+    /// @brief Owns a coroutine which was neither awaited nor detached yet.
+    bool valid() const { return bool(h_coro_); }
+
+    bool await_ready() const noexcept { return !h_coro_ || h_coro_.done(); }
+
+    coro::coroutine_handle<> await_suspend(coro::coroutine_handle<> caller) noexcept {
+        h_coro_.promise().continuation_ = caller;
+        return h_coro_;
+    }
+
+    /// Awaiting an empty (default constructed or moved from) task throws.
+    TASK_RET await_resume() {
+        if (!h_coro_) throw std::logic_error("co_await on an empty task");
+        return h_coro_.promise().result();
+    }
+
+    ///
+    /// @brief Start the task without awaiting it, the coroutine frame is
+    ///   freed when it finishes.
+    ///
+    /// Used to launch top level tasks, e.g. from `main` or a callback.
+    ///
+    void detach() {
+        if (!h_coro_) return;
+        auto h = std::exchange(h_coro_, {});
+        if (h.done()) {
+            h.destroy();
+            return;
+        }
+        h.promise().detached_ = true;
+        h.resume();
     }
 
 private:
-    void_to_nothing<TASK_RET>::type ret_value_{};
-    coro::coroutine_handle<> h_coro_;
+    void destroy() {
+        if (h_coro_) h_coro_.destroy();
+    }
+
+    handle_type h_coro_;
 };
 
-class task_promise_base {
+///
+/// Frames are recycled through a per-thread pool, pass `std::allocator_arg,
+/// alloc` as the first coroutine parameters to allocate with `alloc` instead.
+///
+class task_promise_base : public impl::frame_allocation {
 public:
-    auto initial_suspend() {
-        return coro::suspend_never{};
+    /// Resumes the awaiting coroutine, or frees a detached frame.
+    struct final_awaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template<typename PROMISE>
+        coro::coroutine_handle<> await_suspend(coro::coroutine_handle<PROMISE> h) noexcept {
+            auto& promise = h.promise();
+            if (promise.detached_) {
+                if (promise.m_exception) {
+                    LOG_ERROR("detached task ended by an exception");
+                }
+                h.destroy();
+                return coro::noop_coroutine();
+            }
+            if (promise.continuation_) return promise.continuation_;
+            return coro::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    auto initial_suspend() noexcept {
+        return coro::suspend_always{};
     }
 
     auto final_suspend() noexcept {
-        return coro::suspend_never{};
+        return final_awaiter{};
     }
 
     void unhandled_exception() {
         m_exception = std::current_exception();
     }
 
+protected:
+    void rethrow_if_exception() {
+        if (m_exception) std::rethrow_exception(m_exception);
+    }
+
 private:
+    template<typename TASK_RET> friend class task;
+
+    coro::coroutine_handle<> continuation_;
+    bool detached_ = false;
     std::exception_ptr m_exception;
 };
 
@@ -85,15 +178,19 @@ public:
         return task<TASK_RET>(coro::coroutine_handle<task_promise>::from_promise(*this));
     }
 
-    ~task_promise() { LOG_DEBUG("~task_promise"); }
-
-    void return_value(TASK_RET value) {
-        LOG_DEBUG("return_value: {}", value);
+    template<typename VALUE>
+        requires std::is_convertible_v<VALUE&&, TASK_RET>
+    void return_value(VALUE&& value) {
+        value_.emplace(std::forward<VALUE>(value));
+    }
 
-        auto h = coro::coroutine_handle<task_promise>::from_promise(*this);
-        auto task = reinterpret_cast<task_type*>(h.address());
-        task->ret_value_ = value;
+    TASK_RET result() {
+        rethrow_if_exception();
+        return std::move(*value_);
     }
+
+private:
+    std::optional<TASK_RET> value_;
 };
 
 
@@ -104,9 +201,9 @@ public:
         return task<void>(coro::coroutine_handle<task_promise>::from_promise(*this));
     }
 
-    void return_void() {
-        LOG_DEBUG("return void");
-    }
+    void return_void() {}
+
+    void result() { rethrow_if_exception(); }
 };
 
 template<typename CORO_RET, typename STORAGE_T = std::any>
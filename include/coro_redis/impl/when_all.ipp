@@ -0,0 +1,361 @@
+//
+// Copyright (c) 2020 Gu.Qiwei(gqwmail@qq.com)
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+//
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <coro_redis/impl/reply.ipp>
+#include <coro_redis/impl/task.ipp>
+
+namespace coro_redis {
+
+template <typename A>
+concept Awaitable = requires(A& a, coro::coroutine_handle<> h) {
+  { a.await_ready() } -> std::convertible_to<bool>;
+  a.await_suspend(h);
+  a.await_resume();
+};
+
+namespace impl {
+
+template <typename A>
+using await_result_raw_t = decltype(std::declval<A&>().await_resume());
+
+// void results are reported as std::monostate.
+template <typename A>
+using await_result_t =
+    std::conditional_t<std::is_void_v<await_result_raw_t<A>>, std::monostate,
+                       std::remove_cvref_t<await_result_raw_t<A>>>;
+
+// A reply_view is freed when the operand's reply callback returns, before
+// the combinator resumes the parent.
+template <typename T>
+inline constexpr bool borrows_reply_v = std::is_same_v<T, reply_view>;
+template <typename T>
+inline constexpr bool borrows_reply_v<std::optional<T>> = borrows_reply_v<T>;
+
+///
+/// Detached coroutine awaiting one operand of when_all/when_any. It frees
+/// itself when done and transfers to the handle it returned, the parent
+/// when it completed the group, otherwise nothing.
+///
+class when_child {
+ public:
+  struct promise_type : frame_allocation {
+    struct final_awaiter {
+      bool await_ready() const noexcept { return false; }
+      coro::coroutine_handle<> await_suspend(
+          coro::coroutine_handle<promise_type> h) noexcept {
+        auto next = h.promise().next_;
+        h.destroy();
+        return next;
+      }
+      void await_resume() noexcept {}
+    };
+
+    when_child get_return_object() noexcept {
+      return when_child(coro::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    coro::suspend_always initial_suspend() noexcept { return {}; }
+    final_awaiter final_suspend() noexcept { return {}; }
+    void return_value(coro::coroutine_handle<> next) noexcept { next_ = next; }
+    void unhandled_exception() noexcept { std::terminate(); }  // caught in body
+
+    coro::coroutine_handle<> next_;
+  };
+
+  /// Runs the child until its operand suspends or completes.
+  void start() { h_.resume(); }
+
+ private:
+  explicit when_child(coro::coroutine_handle<promise_type> h) : h_(h) {}
+
+  coro::coroutine_handle<promise_type> h_;
+};
+
+// Awaits `a` and hands the result or the exception to `st`.
+template <typename State, typename Index, typename A>
+when_child run_child(State st, Index i, A a) {
+  std::optional<await_result_t<A>> value;
+  std::exception_ptr error;
+  try {
+    if constexpr (std::is_void_v<await_result_raw_t<A>>) {
+      co_await std::move(a);
+      value.emplace();
+    } else {
+      value.emplace(co_await std::move(a));
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  if (error) co_return (*st).fail(i, std::move(error));
+  co_return (*st).set(i, std::move(*value));
+}
+
+///
+/// State of when_all, it lives in the awaiter which the parent frame keeps
+/// until every child arrived.
+///
+template <typename Results>
+class when_all_state {
+ public:
+  // One count per child plus one for the launcher.
+  explicit when_all_state(size_t children) : remaining_(children + 1) {}
+
+  template <size_t I, typename V>
+  coro::coroutine_handle<> set(std::integral_constant<size_t, I>, V&& v) {
+    std::get<I>(results_).emplace(std::forward<V>(v));
+    return arrive();
+  }
+
+  template <typename V>
+  coro::coroutine_handle<> set(size_t i, V&& v) {
+    results_[i].emplace(std::forward<V>(v));
+    return arrive();
+  }
+
+  template <typename Index>
+  coro::coroutine_handle<> fail(Index, std::exception_ptr e) {
+    if (!failed_.exchange(true, std::memory_order_relaxed)) error_ = std::move(e);
+    return arrive();
+  }
+
+  /// Returns true if every child already completed, the launcher then arrived
+  /// last and must not suspend the parent.
+  bool launched(coro::coroutine_handle<> parent) { return arrive() == parent; }
+
+  void set_parent(coro::coroutine_handle<> parent) { parent_ = parent; }
+
+  Results& results() {
+    if (error_) std::rethrow_exception(error_);
+    return results_;
+  }
+
+  void resize(size_t n) { results_.resize(n); }
+
+ private:
+  // Must not touch the state after the decrement unless it was the last.
+  coro::coroutine_handle<> arrive() {
+    auto parent = parent_;
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) return parent;
+    return coro::noop_coroutine();
+  }
+
+  Results results_;
+  std::atomic<size_t> remaining_;
+  std::atomic<bool> failed_{false};
+  std::exception_ptr error_;
+  coro::coroutine_handle<> parent_;
+};
+
+template <typename... As>
+class when_all_awaiter {
+  static_assert((!borrows_reply_v<await_result_t<As>> && ...),
+                "reply_view does not outlive the reply callback");
+
+ public:
+  using state_t = when_all_state<std::tuple<std::optional<await_result_t<As>>...>>;
+  using result_type = std::tuple<await_result_t<As>...>;
+
+  explicit when_all_awaiter(As... as) : ops_(std::move(as)...), state_(sizeof...(As)) {}
+
+  bool await_ready() const noexcept { return sizeof...(As) == 0; }
+
+  bool await_suspend(coro::coroutine_handle<> h) {
+    state_.set_parent(h);
+    launch(std::index_sequence_for<As...>{});
+    return !state_.launched(h);
+  }
+
+  result_type await_resume() {
+    return std::apply(
+        [](auto&... r) { return result_type(std::move(*r)...); }, state_.results());
+  }
+
+ private:
+  template <size_t... Is>
+  void launch(std::index_sequence<Is...>) {
+    (run_child(&state_, std::integral_constant<size_t, Is>{},
+               std::move(std::get<Is>(ops_)))
+         .start(),
+     ...);
+  }
+
+  std::tuple<As...> ops_;
+  state_t state_;
+};
+
+template <typename A>
+class when_all_range_awaiter {
+  static_assert(!borrows_reply_v<await_result_t<A>>,
+                "reply_view does not outlive the reply callback");
+
+ public:
+  using state_t = when_all_state<std::vector<std::optional<await_result_t<A>>>>;
+  using result_type = std::vector<await_result_t<A>>;
+
+  explicit when_all_range_awaiter(std::vector<A> ops)
+      : ops_(std::move(ops)), state_(ops_.size()) {}
+
+  bool await_ready() const noexcept { return ops_.empty(); }
+
+  bool await_suspend(coro::coroutine_handle<> h) {
+    state_.set_parent(h);
+    state_.resize(ops_.size());
+    for (size_t i = 0; i < ops_.size(); ++i) {
+      run_child(&state_, i, std::move(ops_[i])).start();
+    }
+    return !state_.launched(h);
+  }
+
+  result_type await_resume() {
+    result_type ret;
+    if (ops_.empty()) return ret;
+    auto& results = state_.results();
+    ret.reserve(results.size());
+    for (auto& r : results) ret.push_back(std::move(*r));
+    return ret;
+  }
+
+ private:
+  std::vector<A> ops_;
+  state_t state_;
+};
+
+///
+/// State of when_any, shared with the children: the losers still run after
+/// the parent resumed and went on.
+///
+template <typename Result>
+class when_any_state {
+ public:
+  template <typename Index, typename V>
+  coro::coroutine_handle<> set(Index i, V&& v) {
+    if (won_.exchange(true, std::memory_order_acq_rel)) return coro::noop_coroutine();
+    if constexpr (std::is_same_v<Index, size_t>) {
+      result_.emplace(i, std::forward<V>(v));
+    } else {
+      result_.emplace(std::in_place_index<Index::value>, std::forward<V>(v));
+    }
+    return arrive();
+  }
+
+  template <typename Index>
+  coro::coroutine_handle<> fail(Index, std::exception_ptr e) {
+    if (won_.exchange(true, std::memory_order_acq_rel)) return coro::noop_coroutine();
+    error_ = std::move(e);
+    return arrive();
+  }
+
+  bool done() const { return won_.load(std::memory_order_acquire); }
+
+  void set_parent(coro::coroutine_handle<> parent) { parent_ = parent; }
+
+  /// Returns true if the winner already completed, the launcher then arrived
+  /// last and must not suspend the parent.
+  bool launched(coro::coroutine_handle<> parent) { return arrive() == parent; }
+
+  Result result() {
+    if (error_) std::rethrow_exception(error_);
+    return std::move(*result_);
+  }
+
+ private:
+  // The winner and the launcher.
+  coro::coroutine_handle<> arrive() {
+    if (gate_.fetch_sub(1, std::memory_order_acq_rel) == 1) return parent_;
+    return coro::noop_coroutine();
+  }
+
+  std::optional<Result> result_;
+  std::exception_ptr error_;
+  std::atomic<bool> won_{false};
+  std::atomic<int> gate_{2};
+  coro::coroutine_handle<> parent_;
+};
+
+template <typename... As>
+class when_any_awaiter {
+  static_assert((!borrows_reply_v<await_result_t<As>> && ...),
+                "reply_view does not outlive the reply callback");
+
+ public:
+  using result_type = std::variant<await_result_t<As>...>;
+  using state_t = when_any_state<result_type>;
+
+  explicit when_any_awaiter(As... as)
+      : ops_(std::move(as)...), state_(std::make_shared<state_t>()) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  bool await_suspend(coro::coroutine_handle<> h) {
+    state_->set_parent(h);
+    launch(std::index_sequence_for<As...>{});
+    return !state_->launched(h);
+  }
+
+  /// The variant index tells which operand completed first.
+  result_type await_resume() { return state_->result(); }
+
+ private:
+  // Operands after one which completed at once are not started.
+  template <size_t... Is>
+  void launch(std::index_sequence<Is...>) {
+    ((state_->done() ? void()
+                     : run_child(state_, std::integral_constant<size_t, Is>{},
+                                 std::move(std::get<Is>(ops_)))
+                           .start()),
+     ...);
+  }
+
+  std::tuple<As...> ops_;
+  std::shared_ptr<state_t> state_;
+};
+
+template <typename A>
+class when_any_range_awaiter {
+  static_assert(!borrows_reply_v<await_result_t<A>>,
+                "reply_view does not outlive the reply callback");
+
+ public:
+  using result_type = std::pair<size_t, await_result_t<A>>;
+  using state_t = when_any_state<result_type>;
+
+  explicit when_any_range_awaiter(std::vector<A> ops)
+      : ops_(std::move(ops)), state_(std::make_shared<state_t>()) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  bool await_suspend(coro::coroutine_handle<> h) {
+    assert(!ops_.empty() && "when_any of nothing never completes");
+    state_->set_parent(h);
+    for (size_t i = 0; i < ops_.size() && !state_->done(); ++i) {
+      run_child(state_, i, std::move(ops_[i])).start();
+    }
+    return !state_->launched(h);
+  }
+
+  /// The index of the operand which completed first and its result.
+  result_type await_resume() { return state_->result(); }
+
+ private:
+  std::vector<A> ops_;
+  std::shared_ptr<state_t> state_;
+};
+
+}  // namespace impl
+}  // namespace coro_redis
@@ -7,7 +7,6 @@
 //
 #pragma once
 
-#include <fmt/format.h>
 #include <hiredis/hiredis.h>
 
 #include <coro_redis/impl/sync_connection.ipp>
@@ -23,23 +22,57 @@ class sync_connection {
     /// @brief construction
     ///
     /// @param ctx Redis synchronous context
+    /// @param protocol RESP3 sends `HELLO 3` and falls back to RESP2 if the
+    ///   server does not support it
     ///
-    sync_connection(redisContext* ctx) : impl_(ctx) { }
+    sync_connection(redisContext* ctx,
+                    RedisProtocol protocol = RedisProtocol::RESP2)
+        : impl_(ctx, protocol) { }
+
+    /// @brief Protocol in use for this connection.
+    RedisProtocol protocol() const { return impl_.protocol(); }
+
+    /// @brief Start a batch of commands sent with one write, instead of one
+    ///   round trip per command.
+    ///
+    /// Example:
+    /// @code{.cpp}
+    ///   auto batch = conn->batch();
+    ///   for (auto& key : keys) batch.add("get", key);
+    ///   std::vector<std::optional<std::string>> vals = batch.exec();
+    /// @endcode
+    sync_batch batch() const { return sync_batch(&impl_); }
 
     /// @brief Send redis command.
-    /// @param cmd Redis command.
+    /// @param cmd Redis command, arguments are separated by whitespace.
     /// @return Redis return.
     template <typename RET = std::string>
     std::optional<RET> command(std::string_view cmd) const {
         return impl_.command<RET>(cmd);
     }
 
+    /// @brief Send redis command.
+    /// @param cmd Redis command, arguments are separated by whitespace.
+    /// @param op Callback for deal redis reply.
+    /// @return Redis return.
     template <typename RET = std::string>
-    std::optional<RET> command(std::string_view cmd,
-                               std::function<void(redisReply*)> op) const {
-        return impl_.command<RET>(cmd, op);
+    std::optional<RET> command(
+        std::string_view cmd,
+        std::function<std::optional<RET>(redisReply*)> op) const {
+        return impl_.command<RET>(cmd, std::move(op));
     }
 
+    /// @brief Send redis command with binary safe arguments.
+    /// @param name Command name.
+    /// @param args Arguments, strings or numbers, each one is sent as it is.
+    /// @return Redis return.
+    /// @note Use `reply_view` as return type to read the reply without
+    ///   copying it.
+    template <typename RET = std::string, typename... Args>
+    std::optional<RET> command_argv(std::string_view name,
+                                    Args&&... args) const {
+        return impl_.command_argv<RET>(name, std::forward<Args>(args)...);
+    }
 
     /// @brief Send password to Redis.
     /// @param password Password.
@@ -47,7 +80,7 @@ class sync_connection {
     ///       Instead, you should set password with `ConnectionOptions` or URI.
     /// @see https://redis.io/commands/auth
     inline std::optional<std::string> auth(std::string_view password) {
-        return impl_.command<std::string>(fmt::format("auth {}", password));
+        return impl_.command_argv<std::string, "auth">(password);
     }
 
     /// @brief Send user and password to Redis.
@@ -59,8 +92,7 @@ class sync_connection {
     /// @see https://redis.io/commands/auth
     inline std::optional<std::string> auth(std::string_view user,
                                            std::string_view password) {
-        return impl_.command<std::string>(
-                   fmt::format("auth {} {}", user, password));
+        return impl_.command_argv<std::string, "auth">(user, password);
     }
 
     /// @brief Ask Redis to return the given message.
@@ -68,14 +100,14 @@ class sync_connection {
     /// @return Return the given message.
     /// @see https://redis.io/commands/echo
     inline std::optional<std::string> echo(std::string_view msg) const {
-        return impl_.command<std::string>(fmt::format("echo {}", msg));
+        return impl_.command_argv<std::string, "echo">(msg);
     }
 
     /// @brief Test if the connection is alive.
     /// @return Always return *PONG*.
     /// @see https://redis.io/commands/ping
     inline std::optional<std::string> ping() {
-        return impl_.command<std::string>("ping");
+        return impl_.command_argv<std::string, "ping">();
     }
 
     /// @brief Test if the connection is alive.
@@ -83,20 +115,20 @@ class sync_connection {
     /// @return Return the given message.
     /// @see https://redis.io/commands/ping
     inline std::optional<std::string> ping(std::string_view msg) {
-        return impl_.command<std::string>(fmt::format("ping {}", msg));
+        return impl_.command_argv<std::string, "ping">(msg);
     }
 
     /// @brief After sending QUIT, only the current connection will be close,
     /// while other connections in the pool is still open.
     /// @see https://redis.io/commands/quit
     inline std::optional<std::string> quit() {
-        return impl_.command<std::string>(fmt::format("quit"));
+        return impl_.command_argv<std::string, "quit">();
     }
 
     /// @brief Select the Redis logical database
     /// @see https://redis.io/commands/select
     inline std::optional<std::string> select(uint64_t idx) {
-        return impl_.command<std::string>(fmt::format("select {}", idx));
+        return impl_.command_argv<std::string, "select">(idx);
     }
 
     /// @brief Swap two Redis databases.
@@ -104,7 +136,7 @@ class sync_connection {
     /// @param idx2 The index of the second database.
     /// @see https://redis.io/commands/swapdb
     inline std::optional<std::string> swapdb(uint64_t idx1, uint64_t idx2) {
-        return impl_.command<std::string>(fmt::format("swapdb {} {}", idx1, idx2));
+        return impl_.command_argv<std::string, "swapdb">(idx1, idx2);
     }
 
     // SERVER commands.
@@ -112,20 +144,20 @@ class sync_connection {
     /// @brief Rewrite AOF in the background.
     /// @see https://redis.io/commands/bgrewriteaof
     inline std::optional<std::string> bgrewriteaof() {
-        return impl_.command<std::string>("bgrewriteaof");
+        return impl_.command_argv<std::string, "bgrewriteaof">();
     }
 
     /// @brief Save database in the background.
     /// @see https://redis.io/commands/bgsave
     inline std::optional<std::string> bgsave() {
-        return impl_.command<std::string>("bgsave");
+        return impl_.command_argv<std::string, "bgsave">();
     }
 
     /// @brief Get the size of the currently selected database.
     /// @return Number of keys in currently selected database.
     /// @see https://redis.io/commands/dbsize
     inline std::optional<uint64_t> dbsize() {
-        return impl_.command<uint64_t>("dbsize");
+        return impl_.command_argv<uint64_t, "dbsize">();
     }
 
     /// @brief Remove keys of all databases.
@@ -133,8 +165,7 @@ class sync_connection {
     /// blocking the server.
     /// @see https://redis.io/commands/flushall
     inline std::optional<std::string> flushall(bool async = false) {
-        return impl_.command<std::string>(async ? "FLUSHALL ASYNC"
-                                          : "FLUSHALL SYNC");
+        return impl_.command_argv<std::string, "flushall">(async ? "ASYNC" : "SYNC");
     }
 
     /// @brief Remove keys of current databases.
@@ -142,14 +173,14 @@ class sync_connection {
     /// blocking the server.
     /// @see https://redis.io/commands/flushdb
     inline std::optional<std::string> flushdb(bool async = false) {
-        return impl_.command<std::string>(async ? "FLUSHDB ASYNC" : "FLUSHDB SYNC");
+        return impl_.command_argv<std::string, "flushdb">(async ? "ASYNC" : "SYNC");
     }
 
     /// @brief Get the info about the server.
     /// @return Server info.
     /// @see https://redis.io/commands/info
     inline std::optional<std::string> info() {
-        return impl_.command<std::string>("info");
+        return impl_.command_argv<std::string, "info">();
     }
 
     /// @brief Get the info about the server on the given section.
@@ -157,7 +188,7 @@ class sync_connection {
     /// @return Server info.
     /// @see https://redis.io/commands/info
     inline std::optional<std::string> info(std::string_view section) {
-        return impl_.command<std::string>(fmt::format("info {}", section));
+        return impl_.command_argv<std::string, "info">(section);
     }
 
     /// @brief Get the UNIX timestamp in seconds, at which the database was saved
@@ -165,14 +196,14 @@ class sync_connection {
     /// @return The last saving time.
     /// @see https://redis.io/commands/lastsave
     inline std::optional<uint64_t> lastsave() {
-        return impl_.command<uint64_t>("lastsave");
+        return impl_.command_argv<uint64_t, "lastsave">();
     }
 
     /// @brief Save databases into RDB file **synchronously**, i.e. block the
     /// server during saving.
     /// @see https://redis.io/commands/save
     inline std::optional<std::string> save() {
-        return impl_.command<std::string>("save");
+        return impl_.command_argv<std::string, "save">();
     }
 
     // KEY commands.
@@ -185,9 +216,17 @@ class sync_connection {
     /// @see https://redis.io/commands/del
     template <typename... Args>
     inline std::optional<uint64_t> del(Args && ... keys) {
-        std::string cmd("del");
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "del">(keys...);
+    }
+
+    /// @brief Delete every key of the given range.
+    /// @param keys Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/del
+    template <RedisKeyRange R>
+    inline std::optional<uint64_t> del(R&& keys) {
+        impl::command_args args("del");
+        args.append_range(keys);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Get the serialized valued stored at key.
@@ -197,7 +236,7 @@ class sync_connection {
     /// (`std::nullopt`).
     /// @see https://redis.io/commands/dump
     inline std::optional<std::string> dump(std::string_view key) {
-        return impl_.command<std::string>(fmt::format("dump {}", key));
+        return impl_.command_argv<std::string, "dump">(key);
     }
 
     /// @brief Check if the given key exists.
@@ -208,9 +247,17 @@ class sync_connection {
     /// @see https://redis.io/commands/exists
     template <typename... Args>
     inline std::optional<uint64_t> exists(Args && ... keys) {
-        std::string cmd("exists");
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "exists">(keys...);
+    }
+
+    /// @brief Count how many keys of the given range exist.
+    /// @param keys Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/exists
+    template <RedisKeyRange R>
+    inline std::optional<uint64_t> exists(R&& keys) {
+        impl::command_args args("exists");
+        args.append_range(keys);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Set a timeout on key.
@@ -221,7 +268,7 @@ class sync_connection {
     /// @retval 0 If key does not exist.
     /// @see https://redis.io/commands/expire
     inline std::optional<uint64_t> expire(std::string_view key, uint64_t timeout) {
-        return impl_.command<uint64_t>(fmt::format("expire {} {}", key, timeout));
+        return impl_.command_argv<uint64_t, "expire">(key, timeout);
     }
 
     /// @brief Set a timeout on key, i.e. expire the key at a future time point.
@@ -233,8 +280,7 @@ class sync_connection {
     /// @see https://redis.io/commands/expireat
     inline std::optional<uint64_t> expireat(std::string_view key,
                                             uint64_t timestamp) {
-        return impl_.command<uint64_t>(
-                   fmt::format("expireat {} {}", key, timestamp));
+        return impl_.command_argv<uint64_t, "expireat">(key, timestamp);
     }
 
     /// @brief Get keys matching the given pattern.
@@ -247,8 +293,7 @@ class sync_connection {
     /// @see `Redis::scan`
     /// @see https://redis.io/commands/keys
     // inline std::optional<std::vector<std::string>> keys(std::string_view pattern) {
-    //	return impl_.command<std::vector<std::string>>(fmt::format("keys {}",
-    // pattern));
+    //	return impl_.command_argv<std::vector<std::string>, "keys">(pattern);
     //}
 
     /// @brief Move a key to the given database.
@@ -259,7 +304,7 @@ class sync_connection {
     /// @retval false If key was not moved.
     /// @see https://redis.io/commands/move
     inline std::optional<uint64_t> move(std::string_view key, uint64_t db) {
-        return impl_.command<uint64_t>(fmt::format("move {} {}", key, db));
+        return impl_.command_argv<uint64_t, "move">(key, db);
     }
 
     /// @brief Remove timeout on key.
@@ -270,7 +315,7 @@ class sync_connection {
     /// timeout.
     /// @see https://redis.io/commands/persist
     inline std::optional<uint64_t> persist(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("persist {}", key));
+        return impl_.command_argv<uint64_t, "persist">(key);
     }
 
     /// @brief Set a timeout on key.
@@ -281,7 +326,7 @@ class sync_connection {
     /// @retval false If key does not exist.
     /// @see https://redis.io/commands/pexpire
     inline std::optional<uint64_t> pexpire(std::string_view key, uint64_t timeout) {
-        return impl_.command<uint64_t>(fmt::format("pexpire {} {}", key, timeout));
+        return impl_.command_argv<uint64_t, "pexpire">(key, timeout);
     }
 
     /// @brief Set a timeout on key, i.e. expire the key at a future time point.
@@ -293,8 +338,7 @@ class sync_connection {
     /// @see https://redis.io/commands/pexpireat
     inline std::optional<uint64_t> pexpireat(std::string_view key,
             uint64_t timestamp) {
-        return impl_.command<uint64_t>(
-                   fmt::format("pexpireat {} {}", key, timestamp));
+        return impl_.command_argv<uint64_t, "pexpireat">(key, timestamp);
     }
 
     /// @brief Get the TTL of a key in milliseconds.
@@ -302,7 +346,7 @@ class sync_connection {
     /// @return TTL of the key in milliseconds.
     /// @see https://redis.io/commands/pttl
     inline std::optional<uint64_t> pttl(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("pttl {}", key));
+        return impl_.command_argv<uint64_t, "pttl">(key);
     }
 
     /// @brief Get a random key from current database.
@@ -311,7 +355,7 @@ class sync_connection {
     /// (`std::nullopt`).
     /// @see https://redis.io/commands/randomkey
     inline std::optional<std::string> randomkey() {
-        return impl_.command<std::string>("randomkey");
+        return impl_.command_argv<std::string, "randomkey">();
     }
 
     /// @brief Rename `key` to `newkey`.
@@ -320,7 +364,7 @@ class sync_connection {
     /// @see https://redis.io/commands/rename
     inline std::optional<std::string> rename(std::string_view key,
             std::string_view newkey) {
-        return impl_.command<std::string>(fmt::format("rename {} {}", key, newkey));
+        return impl_.command_argv<std::string, "rename">(key, newkey);
     }
 
     /// @brief Rename `key` to `newkey` if `newkey` does not exist.
@@ -332,7 +376,7 @@ class sync_connection {
     /// @see https://redis.io/commands/renamenx
     inline std::optional<uint64_t> renamenx(std::string_view key,
                                             std::string_view newkey) {
-        return impl_.command<uint64_t>(fmt::format("renamenx {} {}", key, newkey));
+        return impl_.command_argv<uint64_t, "renamenx">(key, newkey);
     }
 
     /// @brief Create a key with the value obtained by `Redis::dump`.
@@ -347,8 +391,9 @@ class sync_connection {
     inline std::optional<std::string> restore(std::string_view key,
             std::string_view val, uint64_t ttl,
             bool replace = false) {
-        return impl_.command<std::string>(
-                   fmt::format("restore {} {} {} {}", key, ttl, val, replace));
+        impl::command_args args("restore", key, ttl, val);
+        if (replace) args.append("REPLACE");
+        return impl_.command<std::string>(args);
     }
 
     // TODO: sort
@@ -384,9 +429,17 @@ class sync_connection {
     /// @see https://redis.io/commands/touch
     template <typename... Args>
     inline std::optional<uint64_t> touch(Args && ... keys) {
-        std::string cmd("touch");
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "touch">(keys...);
+    }
+
+    /// @brief Update the last access time of every key of the given range.
+    /// @param keys Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/touch
+    template <RedisKeyRange R>
+    inline std::optional<uint64_t> touch(R&& keys) {
+        impl::command_args args("touch");
+        args.append_range(keys);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Get the remaining Time-To-Live of a key.
@@ -399,7 +452,7 @@ class sync_connection {
     ///       or if the key exists but does not have a timeout.
     /// @see https://redis.io/commands/ttl
     inline std::optional<uint64_t> ttl(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("ttl {}", key));
+        return impl_.command_argv<uint64_t, "ttl">(key);
     }
 
     /// @brief Get the type of the value stored at key.
@@ -407,7 +460,7 @@ class sync_connection {
     /// @return The type of the value.
     /// @see https://redis.io/commands/type
     inline std::optional<std::string> type(std::string_view key) {
-        return impl_.command<std::string>(fmt::format("type {}", key));
+        return impl_.command_argv<std::string, "type">(key);
     }
 
     /// @brief Remove the given key asynchronously, i.e. without blocking Redis.
@@ -418,9 +471,17 @@ class sync_connection {
     /// @see https://redis.io/commands/unlink
     template <typename... Args>
     inline std::optional<uint64_t> unlink(Args && ... keys) {
-        std::string cmd("unlink");
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "unlink">(keys...);
+    }
+
+    /// @brief Remove every key of the given range in a background thread.
+    /// @param keys Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/unlink
+    template <RedisKeyRange R>
+    inline std::optional<uint64_t> unlink(R&& keys) {
+        impl::command_args args("unlink");
+        args.append_range(keys);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Wait until previous write commands are successfully replicated to
@@ -435,8 +496,7 @@ class sync_connection {
     /// been reached.
     /// @see https://redis.io/commands/wait
     inline std::optional<uint64_t> wait(uint64_t numslaves, uint64_t timeout) {
-        return impl_.command<uint64_t>(
-                   fmt::format("wait {} {}", numslaves, timeout));
+        return impl_.command_argv<uint64_t, "wait">(numslaves, timeout);
     }
 
     // STRING commands.
@@ -448,7 +508,7 @@ class sync_connection {
     /// @see https://redis.io/commands/append
     inline std::optional<uint64_t> append(std::string_view key,
                                           std::string_view str) {
-        return impl_.command<uint64_t>(fmt::format("append {} {}", key, str));
+        return impl_.command_argv<uint64_t, "append">(key, str);
     }
 
     /// @brief Get the number of bits that have been set for the given range of
@@ -463,8 +523,7 @@ class sync_connection {
     /// @see https://redis.io/commands/bitcount
     inline std::optional<uint64_t> bitcount(std::string_view key, uint64_t start = 0,
                                             uint64_t end = -1) {
-        return impl_.command<uint64_t>(
-                   fmt::format("bitcount {} {} {}", key, start, end));
+        return impl_.command_argv<uint64_t, "bitcount">(key, start, end);
     }
 
     enum BitOp { AND, OR, XOR, NOT };
@@ -478,23 +537,8 @@ class sync_connection {
     /// @see `BitOp`
     template <typename... Args>
     inline std::optional<uint64_t> bitop(BitOp op, Args && ... keys) {
-        std::string cmd("bitop");
-        switch (op) {
-        case BitOp::AND:
-            cmd.append(" AND ");
-            break;
-        case BitOp::OR:
-            cmd.append(" OR ");
-            break;
-        case BitOp::XOR:
-            cmd.append(" XOR ");
-            break;
-        case BitOp::NOT:
-            cmd.append(" NOT ");
-            break;
-        }
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        constexpr std::string_view ops[] = {"AND", "OR", "XOR", "NOT"};
+        return impl_.command_argv<uint64_t, "bitop">(ops[op], keys...);
     }
 
     /// @brief Get the position of the first bit set to 0 or 1 in the given range
@@ -509,8 +553,7 @@ class sync_connection {
     /// @see https://redis.io/commands/bitpos
     inline std::optional<uint64_t> bitpos(std::string_view key, uint64_t bit,
                                           uint64_t start = 0, uint64_t end = -1) {
-        return impl_.command<uint64_t>(
-                   fmt::format("bitpos {} {} {} {}", key, bit, start, end));
+        return impl_.command_argv<uint64_t, "bitpos">(key, bit, start, end);
     }
 
     /// @brief Decrement the integer stored at key by 1.
@@ -518,7 +561,7 @@ class sync_connection {
     /// @return The value after the decrement.
     /// @see https://redis.io/commands/decr
     inline std::optional<uint64_t> decr(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("decr {}", key));
+        return impl_.command_argv<uint64_t, "decr">(key);
     }
 
     /// @brief Decrement the integer stored at key by `decrement`.
@@ -527,7 +570,7 @@ class sync_connection {
     /// @return The value after the decrement.
     /// @see https://redis.io/commands/decrby
     inline std::optional<uint64_t> decrby(std::string_view key, uint64_t decrement) {
-        return impl_.command<uint64_t>(fmt::format("decrby {} {}", key, decrement));
+        return impl_.command_argv<uint64_t, "decrby">(key, decrement);
     }
 
     /// @brief Get the string value stored at key.
@@ -546,7 +589,7 @@ class sync_connection {
     /// (`std::nullopt`).
     /// @see https://redis.io/commands/get
     inline std::optional<std::string> get(std::string_view key) const {
-        return impl_.command<std::string>(fmt::format("get {}", key));
+        return impl_.command_argv<std::string, "get">(key);
     }
 
     /// @brief Get the bit value at offset in the string.
@@ -555,7 +598,7 @@ class sync_connection {
     /// @return The bit value.
     /// @see https://redis.io/commands/getbit
     inline std::optional<uint64_t> getbit(std::string_view key, uint64_t offset) {
-        return impl_.command<uint64_t>(fmt::format("getbit {} {}", key, offset));
+        return impl_.command_argv<uint64_t, "getbit">(key, offset);
     }
 
     /// @brief Get the substring of the string stored at key.
@@ -569,8 +612,7 @@ class sync_connection {
     /// @see https://redis.io/commands/getrange
     inline std::optional<std::string> getrange(std::string_view key, uint64_t start,
             uint64_t end) {
-        return impl_.command<std::string>(
-                   fmt::format("getrange {} {} {}", key, start, end));
+        return impl_.command_argv<std::string, "getrange">(key, start, end);
     }
 
     /// @brief Atomically set the string stored at `key` to `val`, and return the
@@ -584,7 +626,7 @@ class sync_connection {
     /// @see `OptionalString`
     inline std::optional<std::string> getset(std::string_view key,
             std::string_view val) {
-        return impl_.command<std::string>(fmt::format("getset {} {}", key, val));
+        return impl_.command_argv<std::string, "getset">(key, val);
     }
 
     /// @brief Increment the integer stored at key by 1.
@@ -592,7 +634,7 @@ class sync_connection {
     /// @return The value after the increment.
     /// @see https://redis.io/commands/incr
     inline std::optional<uint64_t> incr(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("incr {}", key));
+        return impl_.command_argv<uint64_t, "incr">(key);
     }
 
     /// @brief Increment the integer stored at key by `increment`.
@@ -601,7 +643,7 @@ class sync_connection {
     /// @return The value after the increment.
     /// @see https://redis.io/commands/incrby
     inline std::optional<uint64_t> incrby(std::string_view key, uint64_t increment) {
-        return impl_.command<uint64_t>(fmt::format("incrby {} {}", key, increment));
+        return impl_.command_argv<uint64_t, "incrby">(key, increment);
     }
 
     /// @brief Increment the floating point number stored at key by `increment`.
@@ -611,8 +653,7 @@ class sync_connection {
     /// @see https://redis.io/commands/incrbyfloat
     inline std::optional<std::string> incrbyfloat(std::string_view key,
             double increment) {
-        return impl_.command<std::string>(
-                   fmt::format("incrby {} {}", key, increment));
+        return impl_.command_argv<std::string, "incrbyfloat">(key, increment);
     }
 
     /// @brief Get the values of multiple keys atomically.
@@ -637,11 +678,19 @@ class sync_connection {
     ///       since the given key might not exist (in this case, the value of the
     ///       corresponding key is `OptionalString{}` (`std::nullopt`)).
     /// @see https://redis.io/commands/mget
-    template <typename... Args>
-    inline std::optional<std::vector<std::string>> mget(Args && ... keys) {
-        std::string cmd("mget");
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<std::vector<std::string>>(std::move(cmd));
+    template <typename T = std::vector<std::string>, typename... Args>
+    inline std::optional<T> mget(Args && ... keys) {
+        return impl_.command_argv<T, "mget">(keys...);
+    }
+
+    /// @brief Get the values of every key of the given range.
+    /// @param keys Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/mget
+    template <typename T = std::vector<std::string>, RedisKeyRange R>
+    inline std::optional<T> mget(R&& keys) {
+        impl::command_args args("mget");
+        args.append_range(keys);
+        return impl_.command<T>(std::move(args));
     }
 
     /// @brief Set multiple key-value pairs.
@@ -656,9 +705,17 @@ class sync_connection {
     // requires requires (Args&&...keys) {	((std::string_view(keys)), ...);
     // }
     inline std::optional<std::string> mset(Args && ... keys) {
-        std::string cmd("mset");
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<std::string>(std::move(cmd));
+        return impl_.command_argv<std::string, "mset">(keys...);
+    }
+
+    /// @brief Set every key-value pair of the given range.
+    /// @param kvs Sized range, e.g. `std::vector` or `std::span` of pairs.
+    /// @see https://redis.io/commands/mset
+    template <RedisPairRange R>
+    inline std::optional<std::string> mset(R&& kvs) {
+        impl::command_args args("mset");
+        args.append_range(kvs);
+        return impl_.command<std::string>(std::move(args));
     }
 
     /// @brief Set the given key-value pairs if all specified keys do not exist.
@@ -680,9 +737,17 @@ class sync_connection {
     // requires requires (Args&&...keys) {	((std::string_view(keys)), ...);
     // }
     inline std::optional<std::string> msetnx(Args && ... keys) {
-        std::string cmd("msetnx");
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<std::string>(std::move(cmd));
+        return impl_.command_argv<std::string, "msetnx">(keys...);
+    }
+
+    /// @brief Set every key-value pair of the given range if none of the keys exist.
+    /// @param kvs Sized range, e.g. `std::vector` or `std::span` of pairs.
+    /// @see https://redis.io/commands/msetnx
+    template <RedisPairRange R>
+    inline std::optional<std::string> msetnx(R&& kvs) {
+        impl::command_args args("msetnx");
+        args.append_range(kvs);
+        return impl_.command<std::string>(std::move(args));
     }
 
     /// @brief Set key-value pair with the given timeout in milliseconds.
@@ -692,8 +757,7 @@ class sync_connection {
     /// @see https://redis.io/commands/psetex
     inline std::optional<std::string> psetex(std::string_view key, uint64_t ttl,
             std::string_view val) {
-        return impl_.command<std::string>(
-                   fmt::format("psetex {} {} {}", key, ttl, val));
+        return impl_.command_argv<std::string, "psetex">(key, ttl, val);
     }
 
     /// @brief Set a key-value pair.
@@ -726,7 +790,7 @@ class sync_connection {
     /// @see https://redis.io/commands/set
     // TODO: Support KEEPTTL option for Redis 6.0
     template <RedisSetValueType T>
-    inline std::optional<std::string> set(std::string_view key, T val,
+    inline std::optional<std::string> set(std::string_view key, const T& val,
                                           uint64_t ttl = 0,
                                           RedisTTLType ttl_type = RedisTTLType::EX,
                                           UpdateType type = UpdateType::ALWAYS) {
@@ -742,8 +806,7 @@ class sync_connection {
     /// @see https://redis.io/commands/setex
     inline std::optional<std::string> setex(std::string_view key, uint64_t ttl,
                                             std::string_view val) {
-        return impl_.command<std::string>(
-                   fmt::format("setex {} {} {}", key, ttl, val));
+        return impl_.command_argv<std::string, "setex">(key, ttl, val);
     }
 
     /// @brief Set the key if it does not exist.
@@ -754,7 +817,7 @@ class sync_connection {
     /// @retval false If the key was not set, i.e. the key already exists.
     /// @see https://redis.io/commands/setnx
     inline std::optional<uint64_t> setnx(std::string_view key, std::string_view val) {
-        return impl_.command<uint64_t>(fmt::format("setnx {} {}", key, val));
+        return impl_.command_argv<uint64_t, "setnx">(key, val);
     }
 
     /// @brief Set the substring starting from `offset` to the given value.
@@ -765,8 +828,7 @@ class sync_connection {
     /// @see https://redis.io/commands/setrange
     inline std::optional<uint64_t> setrange(std::string_view key, uint64_t offset,
                                             std::string_view val) {
-        return impl_.command<uint64_t>(
-                   fmt::format("setrange {} {} {}", key, offset, val));
+        return impl_.command_argv<uint64_t, "setrange">(key, offset, val);
     }
 
     /// @brief Get the length of the string stored at key.
@@ -775,7 +837,7 @@ class sync_connection {
     /// @note If key does not exist, `strlen` returns 0.
     /// @see https://redis.io/commands/strlen
     inline std::optional<uint64_t> strlen(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("strlen {}", key));
+        return impl_.command_argv<uint64_t, "strlen">(key);
     }
     /*
             // LIST commands.
@@ -790,8 +852,7 @@ class sync_connection {
             /// @see https://redis.io/commands/blpop
             inline std::optional<std::vector<std::string>> blpop(std::string_view key,
        uint64_t timeout = 0) { return
-       impl_.command<std::vector<std::string>>(fmt::format("blpop {} {}", key,
-       timeout));
+       impl_.command_argv<std::vector<std::string>, "blpop">(key, timeout);
             }
 
             /// @brief Pop the first element of the list in a blocking way.
@@ -1007,7 +1068,7 @@ class sync_connection {
     /// @return The length of the list.
     /// @see https://redis.io/commands/llen
     inline std::optional<uint64_t> llen(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("llen {}", key));
+        return impl_.command_argv<uint64_t, "llen">(key);
     }
 
     /// @brief Pop the first element of the list.
@@ -1026,7 +1087,7 @@ class sync_connection {
     /// (`std::nullopt`).
     /// @see https://redis.io/commands/lpop
     std::optional<std::string> lpop(std::string_view key) {
-        return impl_.command<std::string>(fmt::format("lpop {}", key));
+        return impl_.command_argv<std::string, "lpop">(key);
     }
 
     /// @brief Push an element to the beginning of the list.
@@ -1035,7 +1096,7 @@ class sync_connection {
     /// @return The length of the list after the operation.
     /// @see https://redis.io/commands/lpush
     inline std::optional<uint64_t> lpush(std::string_view key, std::string_view val) {
-        return impl_.command<uint64_t>(fmt::format("lpush {} {}", key, val));
+        return impl_.command_argv<uint64_t, "lpush">(key, val);
     }
 
     /// @brief Push multiple elements to the beginning of the list.
@@ -1052,10 +1113,18 @@ class sync_connection {
     /// @see https://redis.io/commands/lpush
     template <typename... Args>
     inline std::optional<uint64_t> lpush(std::string_view key, Args && ... keys) {
-        std::string cmd("lpush ");
-        cmd.append(key);
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "lpush">(key, keys...);
+    }
+
+    /// @brief Push every element of the given range to the head of the list.
+    /// @param key Key.
+    /// @param elements Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/lpush
+    template <RedisKeyRange R>
+    inline std::optional<uint64_t> lpush(std::string_view key, R&& elements) {
+        impl::command_args args("lpush", key);
+        args.append_range(elements);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Push an element to the beginning of the list, only if the list
@@ -1067,7 +1136,7 @@ class sync_connection {
     // TODO: add a multiple elements overload.
     inline std::optional<uint64_t> lpushx(std::string_view key,
                                           std::string_view val) {
-        return impl_.command<uint64_t>(fmt::format("lpushx {} {}", key, val));
+        return impl_.command_argv<uint64_t, "lpushx">(key, val);
     }
 
     /// @brief Get elements in the given range of the given list.
@@ -1085,10 +1154,10 @@ class sync_connection {
     /// @param output Output iterator to the destination where the results are
     /// saved.
     /// @see https://redis.io/commands/lrange
-    inline std::optional<std::vector<std::string>> lrange(
+    template <typename T = std::vector<std::string>>
+    inline std::optional<T> lrange(
     std::string_view key, uint64_t start, uint64_t stop) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("lrange {} {} {}", key, start, stop));
+        return impl_.command_argv<T, "lrange">(key, start, stop);
     }
     /// @brief Remove the first `count` occurrences of elements equal to `val`.
     /// @param key Key where the list is stored.
@@ -1100,8 +1169,7 @@ class sync_connection {
     /// @see https://redis.io/commands/lrem
     inline std::optional<uint64_t> lrem(std::string_view key, uint64_t count,
                                         std::string_view val) {
-        return impl_.command<uint64_t>(
-                   fmt::format("lrem {} {} {}", key, count, val));
+        return impl_.command_argv<uint64_t, "lrem">(key, count, val);
     }
 
     /// @brief Set the element at the given index to the specified value.
@@ -1111,8 +1179,7 @@ class sync_connection {
     /// @see https://redis.io/commands/lset
     inline std::optional<std::string> lset(std::string_view key, uint64_t index,
                                            std::string_view val) {
-        return impl_.command<std::string>(
-                   fmt::format("lset {} {} {}", key, index, val));
+        return impl_.command_argv<std::string, "lset">(key, index, val);
     }
 
     /// @brief Trim a list to keep only element in the given range.
@@ -1122,8 +1189,7 @@ class sync_connection {
     /// @see https://redis.io/commands/ltrim
     inline std::optional<std::string> ltrim(std::string_view key, uint64_t start,
                                             uint64_t stop) {
-        return impl_.command<std::string>(
-                   fmt::format("ltrim {} {} {}", key, start, stop));
+        return impl_.command_argv<std::string, "ltrim">(key, start, stop);
     }
 
     /// @brief Pop the last element of a list.
@@ -1133,7 +1199,7 @@ class sync_connection {
     /// `OptionalString{}` (`std::nullopt`).
     /// @see https://redis.io/commands/rpop
     inline std::optional<std::string> rpop(std::string_view key) {
-        return impl_.command<std::string>(fmt::format("rpop {}", key));
+        return impl_.command_argv<std::string, "rpop">(key);
     }
 
     /// @brief Pop last element of one list and push it to the left of another
@@ -1146,8 +1212,7 @@ class sync_connection {
     /// @see https://redis.io/commands/brpoplpush
     inline std::optional<std::string> rpoplpush(std::string_view source,
             std::string_view destination) {
-        return impl_.command<std::string>(
-                   fmt::format("rpoplpush {} {}", source, destination));
+        return impl_.command_argv<std::string, "rpoplpush">(source, destination);
     }
 
     /// @brief Push an element to the end of the list.
@@ -1158,10 +1223,18 @@ class sync_connection {
     template <typename... Args>
     inline std::optional<uint64_t> rpush(std::string_view key, std::string_view val,
                                          Args && ... vals) {
-        std::string cmd("rpush ");
-        cmd.append(val);
-        (cmd.append(" ").append(vals), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "rpush">(key, val, vals...);
+    }
+
+    /// @brief Push every element of the given range to the tail of the list.
+    /// @param key Key.
+    /// @param elements Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/rpush
+    template <RedisKeyRange R>
+    inline std::optional<uint64_t> rpush(std::string_view key, R&& elements) {
+        impl::command_args args("rpush", key);
+        args.append_range(elements);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Push an element to the end of the list, only if the list already
@@ -1172,7 +1245,7 @@ class sync_connection {
     /// @see https://redis.io/commands/rpushx
     inline std::optional<uint64_t> rpushx(std::string_view key,
                                           std::string_view val) {
-        return impl_.command<uint64_t>(fmt::format("rpushx {} {}", key, val));
+        return impl_.command_argv<uint64_t, "rpushx">(key, val);
     }
 
     // HASH commands.
@@ -1187,10 +1260,18 @@ class sync_connection {
     template <typename... Args>
     inline std::optional<uint64_t> hdel(std::string_view key, std::string_view field,
                                         Args && ... fields) {
-        std::string cmd("hdel");
-        cmd.append(" ").append(field);
-        (cmd.append(" ").append(fields), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "hdel">(key, field, fields...);
+    }
+
+    /// @brief Remove every field of the given range from the hash.
+    /// @param key Key.
+    /// @param fields Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/hdel
+    template <RedisKeyRange R>
+    inline std::optional<uint64_t> hdel(std::string_view key, R&& fields) {
+        impl::command_args args("hdel", key);
+        args.append_range(fields);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Check if the given field exists in hash.
@@ -1202,7 +1283,7 @@ class sync_connection {
     /// @see https://redis.io/commands/hexists
     inline std::optional<uint64_t> hexists(std::string_view key,
                                            std::string_view field) {
-        return impl_.command<uint64_t>(fmt::format("hexists {} {}", key, field));
+        return impl_.command_argv<uint64_t, "hexists">(key, field);
     }
 
     /// @brief Get the value of the given field.
@@ -1214,27 +1295,27 @@ class sync_connection {
     /// @see https://redis.io/commands/hget
     inline std::optional<std::string> hget(std::string_view key,
                                            std::string_view field) {
-        return impl_.command<std::string>(fmt::format("hget {} {}", key, field));
+        return impl_.command_argv<std::string, "hget">(key, field);
     }
 
     /// @brief Get all field-value pairs of the given hash.
     ///
     /// Example:
     /// @code{.cpp}
-    /// std::unordered_map<std::string, std::string> results;
-    /// // Save all field-value pairs of a Redis hash to an unordered_map<string,
-    /// string>. redis.hgetall("hash", std::inserter(results, results.begin()));
+    /// // flat field, value, field, value... list
+    /// auto flat = co_await redis.hgetall("hash");
+    /// // decoded straight into a map, see `impl::reply_traits`
+    /// auto map = co_await redis.hgetall<std::unordered_map<std::string, std::string>>("hash");
     /// @endcode
+    /// @tparam T Result container.
     /// @param key Key where the hash is stored.
-    /// @param output Output iterator to the destination where the result is
-    /// saved.
     /// @note It's always a bad idea to call `hgetall` on a large hash, since it
     /// will block Redis.
     /// @see `Redis::hscan`
     /// @see https://redis.io/commands/hgetall
-    inline std::optional<std::vector<std::string>> hgetall(std::string_view key) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("hgetall {}", key));
+    template <typename T = std::vector<std::string>>
+    inline std::optional<T> hgetall(std::string_view key) {
+        return impl_.command_argv<T, "hgetall">(key);
     }
 
     /// @brief Increment the integer stored at the given field.
@@ -1245,8 +1326,7 @@ class sync_connection {
     /// @see https://redis.io/commands/hincrby
     inline std::optional<uint64_t> hincrby(
         std::string_view key, std::string_view field, uint64_t increment) {
-        return impl_.command<uint64_t>(
-                   fmt::format("hincrby {} {} {}", key, field, increment));
+        return impl_.command_argv<uint64_t, "hincrby">(key, field, increment);
     }
 
     /// @brief Increment the floating point number stored at the given field.
@@ -1257,8 +1337,7 @@ class sync_connection {
     /// @see https://redis.io/commands/hincrbyfloat
     inline std::optional<double> hincrbyfloat(
         std::string_view key, std::string_view field, double increment) {
-        return impl_.command<double>(
-                   fmt::format("hincrbyfloat {} {} {}", key, field, increment));
+        return impl_.command_argv<double, "hincrbyfloat">(key, field, increment);
     }
 
     /// @brief Get all fields of the given hash.
@@ -1269,9 +1348,9 @@ class sync_connection {
     /// will block Redis.
     /// @see `Redis::hscan`
     /// @see https://redis.io/commands/hkeys
-    inline std::optional<std::vector<std::string>> hkeys(std::string_view key) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("hkeys {}", key));
+    template <typename T = std::vector<std::string>>
+    inline std::optional<T> hkeys(std::string_view key) {
+        return impl_.command_argv<T, "hkeys">(key);
     }
 
     /// @brief Get the number of fields of the given hash.
@@ -1279,7 +1358,7 @@ class sync_connection {
     /// @return Number of fields.
     /// @see https://redis.io/commands/hlen
     inline std::optional<uint64_t> hlen(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("hlen {}", key));
+        return impl_.command_argv<uint64_t, "hlen">(key);
     }
 
     /// @brief Get values of multiple fields.
@@ -1305,14 +1384,21 @@ class sync_connection {
     ///       since the given field might not exist (in this case, the value of
     ///       the corresponding field is `OptionalString{}` (`std::nullopt`)).
     /// @see https://redis.io/commands/hmget
-    template <typename... Args>
-    inline std::optional<std::vector<std::string>> hmget(
+    template <typename T = std::vector<std::string>, typename... Args>
+    inline std::optional<T> hmget(
     std::string_view key, std::string_view field, Args && ... fields) {
-        std::string cmd("hmget ");
-        cmd.append(" ").append(key);
-        cmd.append(" ").append(field);
-        (cmd.append(" ").append(fields), ...);
-        return impl_.command<std::vector<std::string>>(std::move(cmd));
+        return impl_.command_argv<T, "hmget">(key, field, fields...);
+    }
+
+    /// @brief Get the values of every field of the given range.
+    /// @param key Key.
+    /// @param fields Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/hmget
+    template <typename T = std::vector<std::string>, RedisKeyRange R>
+    inline std::optional<T> hmget(std::string_view key, R&& fields) {
+        impl::command_args args("hmget", key);
+        args.append_range(fields);
+        return impl_.command<T>(std::move(args));
     }
 
     /// @brief Set multiple field-value pairs of the given hash.
@@ -1327,15 +1413,21 @@ class sync_connection {
     /// @param last Off-the-end iterator to the range.
     /// @see https://redis.io/commands/hmset
     template <typename... Args>
-    inline std::optional<std::vector<std::string>> hmset(
+    inline std::optional<std::string> hmset(
         std::string_view key, std::string_view field, std::string_view value,
         Args && ... args) {
-        std::string cmd("hmset ");
-        cmd.append(" ").append(key);
-        cmd.append(" ").append(field);
-        cmd.append(" ").append(value);
-        (cmd.append(" ").append(args), ...);
-        return impl_.command<std::vector<std::string>>(std::move(cmd));
+        return impl_.command_argv<std::string, "hmset">(key, field, value, args...);
+    }
+
+    /// @brief Set every field-value pair of the given range.
+    /// @param key Key.
+    /// @param kvs Sized range, e.g. `std::vector` or `std::span` of pairs.
+    /// @see https://redis.io/commands/hmset
+    template <RedisPairRange R>
+    inline std::optional<std::string> hmset(std::string_view key, R&& kvs) {
+        impl::command_args args("hmset", key);
+        args.append_range(kvs);
+        return impl_.command<std::string>(std::move(args));
     }
 
     /// @brief Scan fields of the given hash matching the given pattern.
@@ -1397,11 +1489,7 @@ class sync_connection {
     template <typename... Args>
     inline std::optional<uint64_t> hset(std::string_view key, std::string_view field,
                                         std::string_view val, Args && ... args) {
-        std::string cmd("hset ");
-        cmd.append(" ").append(field);
-        cmd.append(" ").append(val);
-        (cmd.append(" ").append(args), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "hset">(key, field, val, args...);
     }
 
     /// @brief Set multiple fields of the given hash.
@@ -1431,8 +1519,7 @@ class sync_connection {
     /// @see https://redis.io/commands/hsetnx
     inline std::optional<uint64_t> hsetnx(
         std::string_view key, std::string_view field, std::string_view val) {
-        return impl_.command<uint64_t>(
-                   fmt::format("hsetnx {} {} {}", key, field, val));
+        return impl_.command_argv<uint64_t, "hsetnx">(key, field, val);
     }
 
     /// @brief Get the length of the string stored at the given field.
@@ -1442,7 +1529,7 @@ class sync_connection {
     /// @see https://redis.io/commands/hstrlen
     inline std::optional<uint64_t> hstrlen(std::string_view key,
                                            std::string_view field) {
-        return impl_.command<uint64_t>(fmt::format("hstrlen {} {}", key, field));
+        return impl_.command_argv<uint64_t, "hstrlen">(key, field);
     }
 
     /// @brief Get values of all fields stored at the given hash.
@@ -1453,9 +1540,9 @@ class sync_connection {
     /// might block Redis.
     /// @see `Redis::hscan`
     /// @see https://redis.io/commands/hvals
-    inline std::optional<std::vector<std::string>> hvals(std::string_view key) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("hvals {}", key));
+    template <typename T = std::vector<std::string>>
+    inline std::optional<T> hvals(std::string_view key) {
+        return impl_.command_argv<T, "hvals">(key);
     }
 
     // SET commands.
@@ -1470,11 +1557,18 @@ class sync_connection {
     template <typename... Args>
     inline std::optional<uint64_t> sadd(std::string_view key, std::string_view member,
                                         Args && ... members) {
-        std::string cmd("sadd");
-        cmd.append(" ").append(key);
-        cmd.append(" ").append(member);
-        (cmd.append(" ").append(members), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "sadd">(key, member, members...);
+    }
+
+    /// @brief Add every member of the given range to the set.
+    /// @param key Key.
+    /// @param members Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/sadd
+    template <RedisKeyRange R>
+    inline std::optional<uint64_t> sadd(std::string_view key, R&& members) {
+        impl::command_args args("sadd", key);
+        args.append_range(members);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Get the number of members in the set.
@@ -1482,7 +1576,7 @@ class sync_connection {
     /// @return Number of members.
     /// @see https://redis.io/commands/scard
     inline std::optional<uint64_t> scard(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("scard {}", key));
+        return impl_.command_argv<uint64_t, "scard">(key);
     }
 
     /// @brief Get the difference between the first set and all successive sets.
@@ -1493,13 +1587,10 @@ class sync_connection {
     /// @see https://redis.io/commands/sdiff
     // TODO: `void sdiff(const StringView &key, Input first, Input last, Output
     // output)` is better.
-    template <typename... Args>
-    inline std::optional<std::vector<std::string>> sdiff(std::string_view key,
+    template <typename T = std::vector<std::string>, typename... Args>
+    inline std::optional<T> sdiff(std::string_view key,
     Args && ... keys) {
-        std::string cmd("sdiff");
-        cmd.append(" ").append(key);
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<std::vector<std::string>>(std::move(cmd));
+        return impl_.command_argv<T, "sdiff">(key, keys...);
     }
 
     /// @brief Copy set stored at `key` to `destination`.
@@ -1510,11 +1601,7 @@ class sync_connection {
     template <typename... Args>
     inline std::optional<uint64_t> sdiffstore(
         std::string_view destination, std::string_view key, Args && ... keys) {
-        std::string cmd("sdiffstore");
-        cmd.append(" ").append(destination);
-        cmd.append(" ").append(key);
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "sdiffstore">(destination, key, keys...);
     }
 
     /// @brief Get the intersection between the first set and all successive sets.
@@ -1525,13 +1612,10 @@ class sync_connection {
     /// @see https://redis.io/commands/sinter
     // TODO: `void sinter(const StringView &key, Input first, Input last, Output
     // output)` is better.
-    template <typename... Args>
-    inline std::optional<std::vector<std::string>> sinter(std::string_view key,
+    template <typename T = std::vector<std::string>, typename... Args>
+    inline std::optional<T> sinter(std::string_view key,
     Args && ... keys) {
-        std::string cmd("sinter");
-        cmd.append(" ").append(key);
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<std::vector<std::string>>(std::move(cmd));
+        return impl_.command_argv<T, "sinter">(key, keys...);
     }
 
     /// @brief Copy set stored at `key` to `destination`.
@@ -1542,11 +1626,7 @@ class sync_connection {
     template <typename... Args>
     inline std::optional<uint64_t> sinterstore(
         std::string_view destination, std::string_view key, Args && ... keys) {
-        std::string cmd("sinterstore");
-        cmd.append(" ").append(destination);
-        cmd.append(" ").append(key);
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "sinterstore">(destination, key, keys...);
     }
 
     /// @brief Test if `member` exists in the set stored at key.
@@ -1559,7 +1639,7 @@ class sync_connection {
     /// @see https://redis.io/commands/sismember
     inline std::optional<uint64_t> sismember(std::string_view key,
             std::string_view member) {
-        return impl_.command<uint64_t>(fmt::format("sismember {} {}", key, member));
+        return impl_.command_argv<uint64_t, "sismember">(key, member);
     }
 
     /// @brief Get all members in the given set.
@@ -1574,9 +1654,9 @@ class sync_connection {
     /// @param key Key where the set is stored.
     /// @param output Iterator to the destination where the result is saved.
     /// @see https://redis.io/commands/smembers
-    inline std::optional<std::vector<std::string>> smembers(std::string_view key) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("smembers {}", key));
+    template <typename T = std::vector<std::string>>
+    inline std::optional<T> smembers(std::string_view key) {
+        return impl_.command_argv<T, "smembers">(key);
     }
 
     /// @brief Move `member` from one set to another.
@@ -1589,8 +1669,7 @@ class sync_connection {
     inline std::optional<uint64_t> smove(std::string_view source,
                                          std::string_view destination,
                                          std::string_view member) {
-        return impl_.command<uint64_t>(
-                   fmt::format("smove {} {} {}", source, destination, member));
+        return impl_.command_argv<uint64_t, "smove">(source, destination, member);
     }
 
     /// @brief Remove a random member from the set.
@@ -1600,10 +1679,10 @@ class sync_connection {
     /// (`std::nullopt`).
     /// @see `Redis::srandmember`
     /// @see https://redis.io/commands/spop
-    inline std::optional<std::vector<std::string>> spop(std::string_view key,
+    template <typename T = std::vector<std::string>>
+    inline std::optional<T> spop(std::string_view key,
     uint64_t count = 1) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("spop {} {}", key, count));
+        return impl_.command_argv<T, "spop">(key, count);
     }
 
     /// @brief Get a random member of the given set.
@@ -1615,7 +1694,7 @@ class sync_connection {
     /// @see `Redis::spop`
     /// @see https://redis.io/commands/srandmember
     inline std::optional<std::string> srandmember(std::string_view key) {
-        return impl_.command<std::string>(fmt::format("srandmember {}", key));
+        return impl_.command_argv<std::string, "srandmember">(key);
     }
 
     /// @brief Get multiple random members of the given set.
@@ -1626,10 +1705,10 @@ class sync_connection {
     /// @note This method won't remove members from the set.
     /// @see `Redis::spop`
     /// @see https://redis.io/commands/srandmember
-    inline std::optional<std::vector<std::string>> srandmember(std::string_view key,
+    template <typename T = std::vector<std::string>>
+    inline std::optional<T> srandmember(std::string_view key,
     uint64_t count) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("srandmember {} {}", key, count));
+        return impl_.command_argv<T, "srandmember">(key, count);
     }
 
     /// @brief Remove a member from set.
@@ -1642,11 +1721,18 @@ class sync_connection {
     template <typename... Args>
     inline std::optional<uint64_t> srem(std::string_view key, std::string_view member,
                                         Args && ... members) {
-        std::string cmd("srem");
-        cmd.append(" ").append(key);
-        cmd.append(" ").append(member);
-        (cmd.append(" ").append(members), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "srem">(key, member, members...);
+    }
+
+    /// @brief Remove every member of the given range from the set.
+    /// @param key Key.
+    /// @param members Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/srem
+    template <RedisKeyRange R>
+    inline std::optional<uint64_t> srem(std::string_view key, R&& members) {
+        impl::command_args args("srem", key);
+        args.append_range(members);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Scan members of the set matching the given pattern.
@@ -1692,10 +1778,7 @@ class sync_connection {
     // output)` is better.
     template <typename... Args>
     inline std::optional<uint64_t> sunion(std::string_view key, Args && ... keys) {
-        std::string cmd("sunion");
-        cmd.append(" ").append(key);
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "sunion">(key, keys...);
     }
 
     /// @brief Copy set stored at `key` to `destination`.
@@ -1706,11 +1789,7 @@ class sync_connection {
     template <typename... Args>
     inline std::optional<uint64_t> sunionstore(
         std::string_view destination, std::string_view key, Args && ... keys) {
-        std::string cmd("sunionstore");
-        cmd.append(" ").append(destination);
-        cmd.append(" ").append(key);
-        (cmd.append(" ").append(keys), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "sunionstore">(destination, key, keys...);
     }
 
     // SORTED SET commands.
@@ -1725,12 +1804,12 @@ class sync_connection {
     inline std::optional<std::vector<std::string>> bzpopmax(
     std::initializer_list<std::string_view> keys, uint64_t timeout = 0) {
         if (keys.size() == 0) return {};
-        std::string cmd("bzpopmax");
+        impl::command_args args("bzpopmax");
         for (const auto& key : keys) {
-            cmd.append(" ").append(key);
+            args.append(key);
         }
-        cmd.append(" ").append(std::to_string(timeout));
-        return impl_.command<std::vector<std::string>>(std::move(cmd));
+        args.append(timeout);
+        return impl_.command<std::vector<std::string>>(args);
     }
 
     /// @brief Pop the member with lowest score from sorted set in a blocking way.
@@ -1745,12 +1824,12 @@ class sync_connection {
     inline std::optional<std::vector<std::string>> bzpopmin(
     std::initializer_list<std::string_view> keys, uint64_t timeout = 0) {
         if (keys.size() == 0) return {};
-        std::string cmd("bzpopmin");
+        impl::command_args args("bzpopmin");
         for (const auto& key : keys) {
-            cmd.append(" ").append(key);
+            args.append(key);
         }
-        cmd.append(" ").append(std::to_string(timeout));
-        return impl_.command<std::vector<std::string>>(std::move(cmd));
+        args.append(timeout);
+        return impl_.command<std::vector<std::string>>(args);
     }
 
     /// @brief Add or update a member with score to sorted set.
@@ -1859,7 +1938,7 @@ class sync_connection {
     /// @return Number of members in the sorted set.
     /// @see https://redis.io/commands/zcard
     inline std::optional<uint64_t> zcard(std::string_view key) {
-        return impl_.command<uint64_t>(fmt::format("zcard {}", key));
+        return impl_.command_argv<uint64_t, "zcard">(key);
     }
 
     /// @brief Get the number of members with score between a min-max score range.
@@ -1879,8 +1958,7 @@ class sync_connection {
     // TODO: add a string version of Interval: zcount("key", "2.3", "5").
     inline std::optional<uint64_t> zcount(std::string_view key, std::string_view min,
                                           std::string_view max) {
-        return impl_.command<uint64_t>(
-                   fmt::format("zcount {} {} {}", key, min, max));
+        return impl_.command_argv<uint64_t, "zcount">(key, min, max);
     }
 
     /// @brief Increment the score of given member.
@@ -1891,8 +1969,7 @@ class sync_connection {
     /// @see https://redis.io/commands/zincrby
     inline std::optional<double> zincrby(std::string_view key, double increment,
                                          std::string_view member) {
-        return impl_.command<double>(
-                   fmt::format("zincrby {} {} {}", key, increment, member));
+        return impl_.command_argv<double, "zincrby">(key, increment, member);
     }
     /*
             /// @brief Copy a sorted set to another one with the scores being
@@ -1908,8 +1985,7 @@ class sync_connection {
             /// @see https://redis.io/commands/zinterstore
             //inline std::optional<uint64_t> zinterstore(std::string_view destination,
        std::string_view key, double weight) {
-            //	return impl_.command<double>(fmt::format("zinterstore {} {} {}",
-       key, increment, member));
+            //	return impl_.command_argv<double, "zinterstore">(key, increment, member);
             //}
 
 
@@ -1976,8 +2052,7 @@ class sync_connection {
     // TODO: add a string version of Interval: zlexcount("key", "(abc", "abd").
     inline std::optional<uint64_t> zlexcount(
         std::string_view key, std::string_view min, std::string_view max) {
-        return impl_.command<uint64_t>(
-                   fmt::format("zlexcount {} {} {}", key, min, max));
+        return impl_.command_argv<uint64_t, "zlexcount">(key, min, max);
     }
 
     /// @brief Pop the member with highest score from sorted set.
@@ -1989,8 +2064,7 @@ class sync_connection {
     /// @see https://redis.io/commands/zpopmax
     inline std::optional<std::vector<std::string>> zpopmax(std::string_view key,
     uint64_t count = 1) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("zpopmax {} {}", key, count));
+        return impl_.command_argv<std::vector<std::string>, "zpopmax">(key, count);
     }
 
     /// @brief Pop the member with lowest score from sorted set.
@@ -2001,8 +2075,7 @@ class sync_connection {
     /// @see `Redis::bzpopmin`
     /// @see https://redis.io/commands/zpopmin
     inline std::optional<std::vector<std::string>> zpopmin(std::string_view key) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("zpopmin {}", key));
+        return impl_.command_argv<std::vector<std::string>, "zpopmin">(key);
     }
 
     /// @brief Get a range of members by rank (ordered from lowest to highest).
@@ -2010,30 +2083,29 @@ class sync_connection {
     /// Example:
     /// @code{.cpp}
     /// // send *ZRANGE* command without the *WITHSCORES* option:
-    /// std::vector<std::string> result;
-    /// redis.zrange("zset", 0, -1, std::back_inserter(result));
+    /// auto members = co_await redis.zrange("zset", "0", "-1");
     /// // send command with *WITHSCORES* option:
-    /// std::unordered_map<std::string, double> with_score;
-    /// redis.zrange("zset", 0, -1, std::inserter(with_score, with_score.end()));
+    /// auto with_score = co_await redis.zrange<
+    ///     std::vector<std::pair<std::string, double>>>("zset", "0", "-1");
     /// @endcode
+    /// @tparam T Result container.
     /// @param key Key where the sorted set is stored.
-    /// @param start Start rank. Inclusive and can be negative.
-    /// @param stop Stop rank. Inclusive and can be negative.
-    /// @param output Output iterator to the destination where the result is
-    /// saved.
-    /// @note This method can also return the score of each member. If `output` is
-    /// an iterator
-    ///       to a container of `std::string`, we send *ZRANGE key start stop*
-    ///       command. If it's an iterator to a container of
-    ///       `std::pair<std::string, double>`, we send *ZRANGE key start stop
-    ///       WITHSCORES* command. See the *Example* part on how to use this
-    ///       method.
+    /// @param min Start rank. Inclusive and can be negative.
+    /// @param max Stop rank. Inclusive and can be negative.
+    /// @note If `T` is a container of `std::string`, we send *ZRANGE key start
+    ///       stop* command. If it's a container of pairs, e.g.
+    ///       `std::unordered_map<std::string, double>`, we send *ZRANGE key
+    ///       start stop WITHSCORES*.
     /// @see `Redis::zrevrange`
     /// @see https://redis.io/commands/zrange
-    inline std::optional<std::vector<std::string>> zrange(
-    std::string_view key, std::string_view min, std::string_view max) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("zrange {} {} {}", key, min, max));
+    template <typename T = std::vector<std::string>>
+    inline std::optional<T> zrange(std::string_view key, std::string_view min,
+                                   std::string_view max) {
+        impl::command_args args("zrange", key, min, max);
+        if constexpr (impl::reply_stride_v<T> == 2) {
+            args.append("WITHSCORES");
+        }
+        return impl_.command<T>(std::move(args));
     }
 
     /// @brief Get a range of members by lexicographical order (from lowest to
@@ -2062,10 +2134,10 @@ class sync_connection {
     /// @see `Redis::zrevrangebylex`
     /// @see https://redis.io/commands/zrangebylex
     ///
-    inline std::optional<std::vector<std::string>> zrangebylex(
+    template <typename T = std::vector<std::string>>
+    inline std::optional<T> zrangebylex(
     std::string_view key, std::string_view min, std::string_view max) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("zrangebylex {} {} {}", key, min, max));
+        return impl_.command_argv<T, "zrangebylex">(key, min, max);
     }
 
     /// @brief Get a range of members by score (ordered from lowest to highest).
@@ -2100,10 +2172,14 @@ class sync_connection {
     /// parameter.
     /// @see `Redis::zrevrangebyscore`
     /// @see https://redis.io/commands/zrangebyscore
-    inline std::optional<std::vector<std::string>> zrangebyscore(
-    std::string_view key, std::string_view min, std::string_view max) {
-        return impl_.command<std::vector<std::string>>(
-                   fmt::format("zrangebyscore {} {} {}", key, min, max));
+    template <typename T = std::vector<std::string>>
+    inline std::optional<T> zrangebyscore(std::string_view key, std::string_view min,
+                                          std::string_view max) {
+        impl::command_args args("zrangebyscore", key, min, max);
+        if constexpr (impl::reply_stride_v<T> == 2) {
+            args.append("WITHSCORES");
+        }
+        return impl_.command<T>(std::move(args));
     }
 
     /// @brief Get the rank (from low to high) of the given member in the sorted
@@ -2116,7 +2192,7 @@ class sync_connection {
     /// @see https://redis.io/commands/zrank
     inline std::optional<uint64_t> zrank(std::string_view key,
                                          std::string_view member) {
-        return impl_.command<uint64_t>(fmt::format("zrank {} {}", key, member));
+        return impl_.command_argv<uint64_t, "zrank">(key, member);
     }
 
     /// @brief Remove the given member from sorted set.
@@ -2129,11 +2205,18 @@ class sync_connection {
     template <typename... Args>
     inline std::optional<uint64_t> zrem(std::string_view key, std::string_view member,
                                         Args && ... members) {
-        std::string cmd("zrem");
-        cmd.append(" ").append(key);
-        cmd.append(" ").append(member);
-        (cmd.append(" ").append(members), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "zrem">(key, member, members...);
+    }
+
+    /// @brief Remove every member of the given range from the sorted set.
+    /// @param key Key.
+    /// @param members Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/zrem
+    template <RedisKeyRange R>
+    inline std::optional<uint64_t> zrem(std::string_view key, R&& members) {
+        impl::command_args args("zrem", key);
+        args.append_range(members);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
     /// @brief Remove members in the given range of lexicographical order.
@@ -2151,8 +2234,7 @@ class sync_connection {
     /// @see https://redis.io/commands/zremrangebylex
     inline std::optional<uint64_t> zremrangebylex(
         std::string_view key, std::string_view min, std::string_view max) {
-        return impl_.command<uint64_t>(
-                   fmt::format("zremrangebylex {} {} {}", key, min, max));
+        return impl_.command_argv<uint64_t, "zremrangebylex">(key, min, max);
     }
 
     /// @brief Remove members in the given range ordered by rank.
@@ -2163,8 +2245,7 @@ class sync_connection {
     /// @see https://redis.io/commands/zremrangebyrank
     inline std::optional<uint64_t> zremrangebyrank(std::string_view key,
             uint64_t start, uint64_t stop) {
-        return impl_.command<uint64_t>(
-                   fmt::format("zremrangebyrank {} {} {}", key, start, stop));
+        return impl_.command_argv<uint64_t, "zremrangebyrank">(key, start, stop);
     }
 
     /// @brief Remove members in the given range ordered by score.
@@ -2176,8 +2257,7 @@ class sync_connection {
     /// @see https://redis.io/commands/zremrangebyscore
     inline std::optional<uint64_t> zremrangebyscore(
         std::string_view key, std::string_view min, std::string_view max) {
-        return impl_.command<uint64_t>(
-                   fmt::format("zremrangebyscore {} {} {}", key, min, max));
+        return impl_.command_argv<uint64_t, "zremrangebyscore">(key, min, max);
     }
 
     /// @brief Get a range of members by rank (ordered from highest to lowest).
@@ -2209,9 +2289,9 @@ class sync_connection {
     inline std::optional<std::string> zrevrange(std::string_view key, uint64_t start,
             uint64_t stop,
             bool withscores = false) {
-        return impl_.command<std::string>(
-                   fmt::format("zrevrange {} {} {} {}", key, start, stop,
-                               (withscores ? "WITHSCORES" : "")));
+        impl::command_args args("zrevrange", key, start, stop);
+        if (withscores) args.append("WITHSCORES");
+        return impl_.command<std::string>(args);
     }
 
     /// @brief Get a range of members by lexicographical order (from highest to
@@ -2241,8 +2321,7 @@ class sync_connection {
     /// @see https://redis.io/commands/zrevrangebylex
     inline std::optional<std::string> zrevrangebylex(
         std::string_view key, std::string_view min, std::string_view max) {
-        return impl_.command<std::string>(
-                   fmt::format("zrevrangebylex {} {} {}", key, min, max));
+        return impl_.command_argv<std::string, "zrevrangebylex">(key, min, max);
     }
 
     /// @brief Get a range of members by score (ordered from highest to lowest).
@@ -2280,8 +2359,7 @@ class sync_connection {
     template <typename Interval, typename Output>
     inline std::optional<std::string> zrevrangebyscore(
         std::string_view key, std::string_view min, std::string_view max) {
-        return impl_.command<std::string>(
-                   fmt::format("zrevrangebyscore {} {} {}", key, min, max));
+        return impl_.command_argv<std::string, "zrevrangebyscore">(key, min, max);
     }
 
     /// @brief Get the rank (from high to low) of the given member in the sorted
@@ -2294,7 +2372,7 @@ class sync_connection {
     /// @see https://redis.io/commands/zrevrank
     inline std::optional<uint64_t> zrevrank(std::string_view key,
                                             std::string_view member) {
-        return impl_.command<uint64_t>(fmt::format("zrevrank {} {}", key, member));
+        return impl_.command_argv<uint64_t, "zrevrank">(key, member);
     }
 
     /// @brief Scan all members of the given sorted set.
@@ -2331,7 +2409,7 @@ class sync_connection {
     /// @see https://redis.io/commands/zscore
     inline std::optional<double> zscore(std::string_view key,
                                         std::string_view member) {
-        return impl_.command<double>(fmt::format("zscore {} {}", key, member));
+        return impl_.command_argv<double, "zscore">(key, member);
     }
 
     /// @brief Copy a sorted set to another one with the scores being multiplied
@@ -2420,10 +2498,18 @@ class sync_connection {
     /// @see https://redis.io/commands/pfadd
     template <typename... Args>
     inline std::optional<uint64_t> pfadd(std::string_view key, Args && ... elements) {
-        std::string cmd("pfadd");
-        cmd.append(" ").append(key);
-        (cmd.append(" ").append(elements), ...);
-        return impl_.command<uint64_t>(std::move(cmd));
+        return impl_.command_argv<uint64_t, "pfadd">(key, elements...);
+    }
+
+    /// @brief Add every element of the given range to the HyperLogLog.
+    /// @param key Key.
+    /// @param elements Sized range, e.g. `std::vector` or `std::span`.
+    /// @see https://redis.io/commands/pfadd
+    template <RedisKeyRange R>
+    inline std::optional<uint64_t> pfadd(std::string_view key, R&& elements) {
+        impl::command_args args("pfadd", key);
+        args.append_range(elements);
+        return impl_.command<uint64_t>(std::move(args));
     }
 
   private:
@@ -0,0 +1,97 @@
+//
+// Copyright (c) 2020 Gu.Qiwei(gqwmail@qq.com)
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+//
+#pragma once
+
+#include <coro_redis/impl/when_all.ipp>
+
+namespace coro_redis {
+
+///
+/// @brief Await several operations at once, resumes when all of them are done.
+///
+/// Every operand is started right away, so commands on one or several
+/// connections are in flight together and the fan-out costs about one round
+/// trip. Operands are any awaitables, e.g. commands, pipelines or `task`s,
+/// they are moved into the combinator. `void` results become
+/// `std::monostate`. If an operand throws, the first exception is rethrown
+/// after all of them finished. Operands resulting in `reply_view` are
+/// rejected, the reply is freed before the caller resumes.
+///
+/// Example:
+/// @code{.cpp}
+///   auto [name, age] = co_await when_all(conn1->hget("user", "name"),
+///                                        conn2->hget<uint64_t>("user", "age"));
+/// @endcode
+///
+/// @return `std::tuple` of the operand results.
+///
+template <typename... As>
+    requires(Awaitable<std::decay_t<As>> && ...)
+auto when_all(As&&... as) {
+    return impl::when_all_awaiter<std::decay_t<As>...>(std::forward<As>(as)...);
+}
+
+///
+/// @brief Await a runtime number of operations of one type at once.
+///
+/// The awaiters are stored until `co_await`, and command arguments are
+/// borrowed, not copied (see `command_args`): strings must outlive the
+/// `co_await`, e.g. `gets.push_back(conn->get(prefix + id))` leaves a
+/// dangling key, keep the built keys in a container instead.
+///
+/// Example:
+/// @code{.cpp}
+///   std::vector<awaiter_t<std::string>> gets;
+///   for (auto& field : fields) gets.push_back(conn->hget("user", field));
+///   std::vector<std::optional<std::string>> vals = co_await when_all(std::move(gets));
+/// @endcode
+///
+/// @return Results in operand order.
+///
+template <Awaitable A>
+auto when_all(std::vector<A> ops) {
+    return impl::when_all_range_awaiter<A>(std::move(ops));
+}
+
+///
+/// @brief Await several operations at once, resumes when the first one is done.
+///
+/// The other operations keep running in the background and their results are
+/// dropped, e.g. a command still gets its reply, the connection is not
+/// affected. Operands after one which completes without suspending are not
+/// started. If the first operation to finish throws, the exception is
+/// rethrown.
+///
+/// Example:
+/// @code{.cpp}
+///   auto first = co_await when_any(primary->get("key"), replica->get("key"));
+///   auto val = std::visit([](auto& v) { return v; }, first);
+/// @endcode
+///
+/// @return `std::variant` of the operand results, its index tells which
+///   operation finished first.
+///
+template <typename... As>
+    requires(sizeof...(As) > 0 && (Awaitable<std::decay_t<As>> && ...))
+auto when_any(As&&... as) {
+    return impl::when_any_awaiter<std::decay_t<As>...>(std::forward<As>(as)...);
+}
+
+///
+/// @brief Await a runtime number of operations of one type, resumes when the
+///   first one is done.
+///
+/// @param ops Must not be empty.
+/// @return Index of the first finished operation and its result.
+///
+template <Awaitable A>
+auto when_any(std::vector<A> ops) {
+    return impl::when_any_range_awaiter<A>(std::move(ops));
+}
+
+}  // namespace coro_redis